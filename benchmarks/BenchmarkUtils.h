@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+// Minimal timing helpers shared by the micro-benchmarks. Every result is the best of a few runs,
+// reported in nanoseconds per operation.
+namespace Bench {
+
+constexpr int REPETITIONS = 5;
+
+template<typename T>
+inline void DoNotOptimize(T const& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void ClobberMemory()
+{
+    asm volatile("" : : : "memory");
+}
+
+// Runs setup() then body() REPETITIONS times; only body() is timed
+template<typename Setup, typename Body>
+double BestNsPerOp(std::size_t operations, Setup&& setup, Body&& body)
+{
+    double best = std::numeric_limits<double>::max();
+
+    for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+    {
+        setup();
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        body();
+        ClobberMemory();
+        auto stopTime = std::chrono::high_resolution_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(stopTime - startTime).count();
+        best = std::min(best, ns / static_cast<double>(operations));
+    }
+
+    return best;
+}
+
+template<typename Body>
+double BestNsPerOp(std::size_t operations, Body&& body)
+{
+    return BestNsPerOp(operations, [] {}, std::forward<Body>(body));
+}
+
+template<typename T>
+std::vector<T> ShuffledRange(std::size_t count, unsigned seed = 42)
+{
+    std::vector<T> values(count);
+    std::iota(values.begin(), values.end(), T{});
+    std::shuffle(values.begin(), values.end(), std::default_random_engine(seed));
+    return values;
+}
+
+inline void PrintHeader(char const* title, char const* columns)
+{
+    std::printf("\n== %s ==\n%s\n", title, columns);
+}
+
+}
@@ -0,0 +1,132 @@
+// Compares ComponentArray (paged sparse-set index, chunked storage) against the previous
+// unordered_map based index (entity -> index and index -> entity maps).
+
+#include "BenchmarkUtils.h"
+#include "core/ComponentArray.h"
+#include "core/Types.h"
+
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+
+// Roughly the size of Transform
+struct Payload
+{
+    float values[15];
+};
+
+
+// The map-based layout ComponentArray used before the sparse set
+class MapComponentArray
+{
+public:
+    void InsertData(Entity entity, Payload component)
+    {
+        std::size_t newIndex = mSize;
+        mEntityToIndexMap[entity] = newIndex;
+        mIndexToEntityMap[newIndex] = entity;
+        if (newIndex == mComponentArray.size()) mComponentArray.push_back(component);
+        else mComponentArray[newIndex] = component;
+        ++mSize;
+    }
+
+    void RemoveData(Entity entity)
+    {
+        std::size_t indexOfRemovedEntity = mEntityToIndexMap[entity];
+        std::size_t indexOfLastElement = mSize - 1;
+        mComponentArray[indexOfRemovedEntity] = mComponentArray[indexOfLastElement];
+
+        Entity entityOfLastElement = mIndexToEntityMap[indexOfLastElement];
+        mEntityToIndexMap[entityOfLastElement] = indexOfRemovedEntity;
+        mIndexToEntityMap[indexOfRemovedEntity] = entityOfLastElement;
+
+        mEntityToIndexMap.erase(entity);
+        mIndexToEntityMap.erase(indexOfLastElement);
+
+        --mSize;
+    }
+
+    Payload& GetData(Entity entity)
+    {
+        return mComponentArray[mEntityToIndexMap[entity]];
+    }
+
+private:
+    std::vector<Payload> mComponentArray{};
+    std::unordered_map<Entity, std::size_t> mEntityToIndexMap{};
+    std::unordered_map<std::size_t, Entity> mIndexToEntityMap{};
+    std::size_t mSize{};
+};
+
+
+struct Results
+{
+    double insert, remove, sequentialGet, randomGet;
+};
+
+template<typename Array>
+Results Run(std::size_t count)
+{
+    // Entities are inserted in shuffled order, as they would be after some churn
+    auto const insertOrder = Bench::ShuffledRange<Entity>(count, 1);
+    auto const randomOrder = Bench::ShuffledRange<Entity>(count, 2);
+
+    Results results{};
+    std::unique_ptr<Array> array;
+
+    auto fresh = [&] { array = std::make_unique<Array>(); };
+    auto filled = [&] {
+        fresh();
+        for (Entity entity : insertOrder) array->InsertData(entity, Payload{});
+    };
+
+    results.insert = Bench::BestNsPerOp(count, fresh, [&] {
+        for (Entity entity : insertOrder) array->InsertData(entity, Payload{});
+    });
+
+    filled();
+
+    results.sequentialGet = Bench::BestNsPerOp(count, [&] {
+        float sum = 0.0f;
+        for (Entity entity = 0; entity < count; ++entity) sum += array->GetData(entity).values[0];
+        Bench::DoNotOptimize(sum);
+    });
+
+    results.randomGet = Bench::BestNsPerOp(count, [&] {
+        float sum = 0.0f;
+        for (Entity entity : randomOrder) sum += array->GetData(entity).values[0];
+        Bench::DoNotOptimize(sum);
+    });
+
+    results.remove = Bench::BestNsPerOp(count, filled, [&] {
+        for (Entity entity : randomOrder) array->RemoveData(entity);
+    });
+
+    return results;
+}
+
+void Print(char const* name, std::size_t count, Results const& results)
+{
+    std::printf("%-8s %9zu %10.2f %10.2f %10.2f %10.2f\n",
+        name, count, results.insert, results.remove, results.sequentialGet, results.randomGet);
+}
+
+}
+
+
+int main()
+{
+    Bench::PrintHeader("ComponentArray index (ns/op)", "layout     entities     insert     remove    seq get   rand get");
+
+    for (std::size_t count : {5'000u, 100'000u, 1'000'000u})
+    {
+        Print("map", count, Run<MapComponentArray>(count));
+        Print("sparse", count, Run<ComponentArray<Payload>>(count));
+    }
+
+    return 0;
+}
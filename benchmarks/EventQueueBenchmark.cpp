@@ -0,0 +1,150 @@
+// Cross-thread event posting under contention: N producer threads post into one channel while the
+// consumer drains it, as systems on worker threads posting to the main thread would. Compares the
+// lock-free MpmcQueue (bulk drain) with a mutex-guarded vector swapped out by the consumer.
+
+#include "BenchmarkUtils.h"
+#include "core/MpmcQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+constexpr std::size_t EVENT_COUNT = 1 << 20;
+constexpr std::size_t QUEUE_CAPACITY = 1 << 14;
+
+// Shaped like a collision or spawn request
+struct PostedEvent
+{
+    std::uint64_t entity{};
+    float position[3]{};
+};
+
+
+class MutexQueue
+{
+public:
+    bool TryPush(PostedEvent const& event)
+    {
+        std::lock_guard lock(mMutex);
+        mEvents.push_back(event);
+        return true;
+    }
+
+    template<typename Fn>
+    std::size_t Drain(Fn&& fn)
+    {
+        {
+            std::lock_guard lock(mMutex);
+            std::swap(mEvents, mDraining);
+        }
+
+        for (auto& event : mDraining)
+        {
+            fn(event);
+        }
+
+        std::size_t count = mDraining.size();
+        mDraining.clear();
+        return count;
+    }
+
+private:
+    std::mutex mMutex;
+    std::vector<PostedEvent> mEvents{};
+    std::vector<PostedEvent> mDraining{};
+};
+
+
+// Milliseconds until every event has been posted and consumed
+template<typename Queue>
+double Run(Queue& queue, std::size_t producerCount)
+{
+    std::atomic<bool> start{false};
+    std::vector<std::thread> producers;
+    std::size_t const perProducer = EVENT_COUNT / producerCount;
+
+    for (std::size_t p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&, p] {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            for (std::size_t i = 0; i < perProducer; ++i)
+            {
+                PostedEvent event{.entity = p * perProducer + i};
+
+                // A full bounded queue pushes back on the producer
+                while (!queue.TryPush(event))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::size_t consumed = 0;
+    std::uint64_t checksum = 0;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    start.store(true, std::memory_order_release);
+
+    while (consumed < perProducer * producerCount)
+    {
+        std::size_t drained = queue.Drain([&](PostedEvent& event) { checksum += event.entity; });
+        consumed += drained;
+
+        if (drained == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    auto stopTime = std::chrono::high_resolution_clock::now();
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    Bench::DoNotOptimize(checksum);
+    return std::chrono::duration<double, std::milli>(stopTime - startTime).count();
+}
+
+template<typename Queue, typename... Args>
+double BestNsPerEvent(std::size_t producerCount, Args... args)
+{
+    double best = 0.0;
+
+    for (int repetition = 0; repetition < Bench::REPETITIONS; ++repetition)
+    {
+        Queue queue(args...);
+        double ms = Run(queue, producerCount);
+        best = repetition == 0 ? ms : std::min(best, ms);
+    }
+
+    return best * 1e6 / static_cast<double>(EVENT_COUNT);
+}
+
+}
+
+
+int main()
+{
+    Bench::PrintHeader("Posting 1M events from N producers (ns/event)", "producers  mutex vector  mpmc queue");
+
+    for (std::size_t producers : {1u, 2u, 4u, 8u, 16u, 32u})
+    {
+        std::printf("%9zu %13.2f %11.2f\n",
+            producers, BestNsPerEvent<MutexQueue>(producers), BestNsPerEvent<MpmcQueue<PostedEvent>>(producers, QUEUE_CAPACITY));
+    }
+
+    return 0;
+}
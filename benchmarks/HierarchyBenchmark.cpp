@@ -0,0 +1,210 @@
+// World-matrix propagation through parent/child hierarchies of 100k nodes. Compares:
+//  - recursive: nodes scattered in memory, each holding a list of children, visited depth first
+//  - linear: TransformHierarchy's breadth-first layout, one forward pass, single threaded and split
+//    across the job system level by level
+//  - dirty: the linear pass after 1% of the nodes changed, and with nothing changed at all
+// over a deep forest (100 chains of 1000), a bushy tree (8 children per node) and a flat one (a
+// single root with every other node as its child).
+
+#include "BenchmarkUtils.h"
+#include "core/JobSystem.h"
+#include "graphics/TransformHierarchy.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+constexpr std::size_t NODE_COUNT = 100'000;
+
+using Matrix = TransformHierarchy::Matrix;
+
+struct Node
+{
+    Matrix local;
+    Matrix world;
+    std::vector<Node*> children;
+};
+
+// parents[i] for shape-order node i, in a shuffled numbering so input order says nothing about the tree
+std::vector<std::uint32_t> Shuffle(std::vector<std::uint32_t> const& parents, std::vector<std::uint32_t> const& order)
+{
+    std::vector<std::uint32_t> shuffled(parents.size());
+
+    for (std::size_t i = 0; i < parents.size(); ++i)
+    {
+        shuffled[order[i]] = parents[i] == TransformHierarchy::NO_PARENT ? TransformHierarchy::NO_PARENT : order[parents[i]];
+    }
+
+    return shuffled;
+}
+
+std::vector<std::uint32_t> DeepParents()
+{
+    std::vector<std::uint32_t> parents(NODE_COUNT);
+
+    for (std::size_t i = 0; i < NODE_COUNT; ++i)
+    {
+        parents[i] = i % 1000 == 0 ? TransformHierarchy::NO_PARENT : static_cast<std::uint32_t>(i - 1);
+    }
+
+    return parents;
+}
+
+std::vector<std::uint32_t> BushyParents()
+{
+    std::vector<std::uint32_t> parents(NODE_COUNT);
+
+    for (std::size_t i = 0; i < NODE_COUNT; ++i)
+    {
+        parents[i] = i == 0 ? TransformHierarchy::NO_PARENT : static_cast<std::uint32_t>((i - 1) / 8);
+    }
+
+    return parents;
+}
+
+std::vector<std::uint32_t> FlatParents()
+{
+    std::vector<std::uint32_t> parents(NODE_COUNT, 0);
+    parents[0] = TransformHierarchy::NO_PARENT;
+
+    return parents;
+}
+
+// Near-identity local matrices, so deep chains neither blow up nor collapse
+std::vector<Matrix> RandomLocals(std::size_t count)
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> offset(-0.01f, 0.01f);
+    std::uniform_real_distribution<float> angle(-0.01f, 0.01f);
+
+    std::vector<Matrix> locals(count);
+    for (auto& local : locals)
+    {
+        TransformMath::WorldMatrix(offset(generator), offset(generator), offset(generator), angle(generator), 1.0f, 1.0f, 1.0f, local.m);
+    }
+
+    return locals;
+}
+
+void Visit(Node& node, Matrix const& parentWorld)
+{
+    TransformMath::Multiply(parentWorld.m, node.local.m, node.world.m);
+
+    for (Node* child : node.children)
+    {
+        Visit(*child, node.world);
+    }
+}
+
+void Row(char const* shape, std::vector<std::uint32_t> const& shapeParents, JobSystem& jobSystem)
+{
+    auto const order = Bench::ShuffledRange<std::uint32_t>(NODE_COUNT);
+    auto const parents = Shuffle(shapeParents, order);
+    auto const locals = RandomLocals(NODE_COUNT);
+
+    // Recursive baseline, nodes allocated in shuffled order
+    std::vector<Node> nodes(NODE_COUNT);
+    std::vector<Node*> roots;
+
+    for (std::size_t i = 0; i < NODE_COUNT; ++i)
+    {
+        nodes[i].local = locals[i];
+
+        if (parents[i] == TransformHierarchy::NO_PARENT)
+        {
+            roots.push_back(&nodes[i]);
+        }
+        else
+        {
+            nodes[parents[i]].children.push_back(&nodes[i]);
+        }
+    }
+
+    Matrix identity{};
+    identity.m[0] = identity.m[5] = identity.m[10] = identity.m[15] = 1.0f;
+
+    double recursiveNs = Bench::BestNsPerOp(NODE_COUNT, [&] {
+        for (Node* root : roots)
+        {
+            Visit(*root, identity);
+        }
+    });
+
+    // A root's local matrix is its world matrix, as under the baseline's identity parent
+    TransformHierarchy hierarchy;
+    hierarchy.Build(parents);
+
+    for (std::uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        std::memcpy(hierarchy.Local(hierarchy.Slot(i)), locals[i].m, sizeof(locals[i].m));
+    }
+
+    auto markAll = [&] {
+        for (std::uint32_t slot = 0; slot < NODE_COUNT; ++slot)
+        {
+            hierarchy.MarkDirty(slot);
+        }
+    };
+
+    double linearNs = Bench::BestNsPerOp(NODE_COUNT, markAll, [&] {
+        hierarchy.Propagate();
+    });
+
+    double parallelNs = Bench::BestNsPerOp(NODE_COUNT, markAll, [&] {
+        hierarchy.Propagate(&jobSystem);
+    });
+
+    hierarchy.ClearDirty();
+
+    // Largest difference from the recursive pass, so a fast but wrong layout shows up
+    float maxError = 0.0f;
+    for (std::uint32_t i = 0; i < NODE_COUNT; ++i)
+    {
+        for (int element = 0; element < 16; ++element)
+        {
+            maxError = std::max(maxError, std::fabs(nodes[i].world.m[element] - hierarchy.World(hierarchy.Slot(i))[element]));
+        }
+    }
+
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<std::uint32_t> pick(0, NODE_COUNT - 1);
+
+    double dirtyNs = Bench::BestNsPerOp(NODE_COUNT, [&] {
+        hierarchy.ClearDirty();
+        for (std::size_t i = 0; i < NODE_COUNT / 100; ++i)
+        {
+            hierarchy.MarkDirty(pick(generator));
+        }
+    }, [&] {
+        hierarchy.Propagate(&jobSystem);
+    });
+
+    double cleanNs = Bench::BestNsPerOp(NODE_COUNT, [&] { hierarchy.ClearDirty(); }, [&] {
+        hierarchy.Propagate(&jobSystem);
+    });
+
+    std::printf("%-6s %7zu %10.2f %8.2f %10.2f %10.2f %7.2f %10.1e\n",
+        shape, hierarchy.LevelCount(), recursiveNs, linearNs, parallelNs, dirtyNs, cleanNs, maxError);
+}
+
+}
+
+
+int main()
+{
+    JobSystem jobSystem;
+
+    std::printf("\n%zu nodes, %zu workers\n", NODE_COUNT, jobSystem.WorkerCount());
+    Bench::PrintHeader("Hierarchy propagation (ns/node)", "shape   levels  recursive   linear  linear par   1% dirty   clean  max error");
+
+    Row("deep", DeepParents(), jobSystem);
+    Row("bushy", BushyParents(), jobSystem);
+    Row("flat", FlatParents(), jobSystem);
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+// std::bitset<N> (the old Signature) vs BasicSignature<N> at several widths, on the two operations
+// signatures are used for in hot paths: system/query matching ((entity & system) == system) and
+// archetype lookup by signature in an unordered_map. The hash alone is timed too, to show how much
+// of a lookup it accounts for.
+
+#include "BenchmarkUtils.h"
+#include "core/Signature.h"
+
+#include <bitset>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+
+constexpr std::size_t SIGNATURE_COUNT = 4096;
+constexpr std::size_t ARCHETYPE_COUNT = 512;
+
+// Sparse masks like real entity signatures: a handful of components out of BITS
+template<typename Mask, std::size_t BITS>
+std::vector<Mask> RandomMasks(std::size_t count, std::size_t setBits, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<std::size_t> bit(0, BITS - 1);
+    std::vector<Mask> masks(count);
+
+    for (auto& mask : masks)
+    {
+        for (std::size_t i = 0; i < setBits; ++i)
+        {
+            mask.set(bit(generator));
+        }
+    }
+
+    return masks;
+}
+
+template<typename Mask>
+bool Includes(Mask const& have, Mask const& need)
+{
+    if constexpr (requires { have.Includes(need); })
+    {
+        return have.Includes(need);
+    }
+    else
+    {
+        return (have & need) == need;
+    }
+}
+
+template<typename Mask, std::size_t BITS>
+double Matching()
+{
+    auto const entities = RandomMasks<Mask, BITS>(SIGNATURE_COUNT, 8, 1);
+    auto const systems = RandomMasks<Mask, BITS>(64, 2, 2);
+
+    return Bench::BestNsPerOp(entities.size() * systems.size(), [&] {
+        std::size_t matches = 0;
+
+        for (auto const& system : systems)
+        {
+            for (auto const& entity : entities)
+            {
+                matches += Includes(entity, system);
+            }
+        }
+
+        Bench::DoNotOptimize(matches);
+    });
+}
+
+template<typename Mask, std::size_t BITS>
+double Lookup()
+{
+    auto const archetypes = RandomMasks<Mask, BITS>(ARCHETYPE_COUNT, 6, 3);
+    std::unordered_map<Mask, std::size_t> map;
+
+    for (std::size_t i = 0; i < archetypes.size(); ++i)
+    {
+        map.emplace(archetypes[i], i);
+    }
+
+    std::vector<Mask> queries;
+    for (std::size_t i = 0; i < SIGNATURE_COUNT; ++i)
+    {
+        queries.push_back(archetypes[(i * 7919) % archetypes.size()]);
+    }
+
+    return Bench::BestNsPerOp(queries.size(), [&] {
+        std::size_t sum = 0;
+
+        for (auto const& query : queries)
+        {
+            sum += map.find(query)->second;
+        }
+
+        Bench::DoNotOptimize(sum);
+    });
+}
+
+template<std::size_t BITS>
+double Hashing()
+{
+    auto const queries = RandomMasks<BasicSignature<BITS>, BITS>(SIGNATURE_COUNT, 6, 3);
+
+    return Bench::BestNsPerOp(queries.size(), [&] {
+        std::size_t sum = 0;
+
+        for (auto const& query : queries)
+        {
+            sum += query.Hash();
+        }
+
+        Bench::DoNotOptimize(sum);
+    });
+}
+
+template<std::size_t BITS>
+void Row()
+{
+    std::printf("%5zu %14.2f %14.2f %14.2f %14.2f %10.2f\n",
+        BITS,
+        Matching<std::bitset<BITS>, BITS>(), Matching<BasicSignature<BITS>, BITS>(),
+        Lookup<std::bitset<BITS>, BITS>(), Lookup<BasicSignature<BITS>, BITS>(), Hashing<BITS>());
+}
+
+}
+
+
+int main()
+{
+    Bench::PrintHeader("Signature matching and archetype lookup (ns/op)", " bits   bitset match      sig match  bitset lookup     sig lookup   sig hash");
+
+    Row<32>();
+    Row<64>();
+    Row<128>();
+    Row<256>();
+    Row<512>();
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+// DynamicAabbTree against brute force over N boxes scattered in a cube 1000 units wide:
+//  - build: inserting every box, and update: moving a tenth of them a short way (most stay inside
+//    their fat box); brute force only stores the box
+//  - frustum: a 90 degree frustum 200 units deep (about 1% of the cube), against the SIMD sphere
+//    pass RenderSystem uses without an index
+//  - ray: closest box along a ray through the cube, against testing every box
+//  - range: boxes within 20 units of a point, against testing every box
+
+#include "BenchmarkUtils.h"
+#include "graphics/DynamicAabbTree.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+constexpr float WORLD_HALF_SIZE = 500.0f;
+constexpr std::size_t QUERY_COUNT = 100;
+
+std::vector<Aabb> RandomBoxes(std::size_t count)
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> position(-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+    std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+    std::vector<Aabb> boxes(count);
+    for (auto& box : boxes)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float center = position(generator);
+            float extent = size(generator);
+            box.min[axis] = center - extent;
+            box.max[axis] = center + extent;
+        }
+    }
+
+    return boxes;
+}
+
+// Perspective looking down -z from the cube's center: fovy 90 degrees, aspect 1, near 1, far 200
+Frustum QueryFrustum()
+{
+    float const near = 1.0f;
+    float const far = 200.0f;
+    float const projection[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, -(far + near) / (far - near), -1.0f,
+        0.0f, 0.0f, -2.0f * far * near / (far - near), 0.0f
+    };
+
+    return Culling::ExtractFrustum(projection);
+}
+
+struct Ray
+{
+    float origin[3];
+    float direction[3];
+    float inverseDirection[3];
+};
+
+std::vector<Ray> RandomRays()
+{
+    std::mt19937 generator(13);
+    std::uniform_real_distribution<float> position(-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+    std::vector<Ray> rays(QUERY_COUNT);
+    for (auto& ray : rays)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            ray.origin[axis] = position(generator);
+            ray.direction[axis] = direction(generator);
+            ray.inverseDirection[axis] = 1.0f / ray.direction[axis];
+        }
+    }
+
+    return rays;
+}
+
+void Row(std::size_t count)
+{
+    auto boxes = RandomBoxes(count);
+    std::size_t const moved = count / 10;
+
+    DynamicAabbTree tree(0.5f);
+    std::vector<std::int32_t> proxies(count);
+
+    double buildNs = Bench::BestNsPerOp(count, [&] { tree = DynamicAabbTree(0.5f); }, [&] {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            proxies[i] = tree.CreateProxy(boxes[i], static_cast<std::uint32_t>(i));
+        }
+    });
+
+    // Every tenth box drifts along x, leaving its fat box every few steps
+    double updateNs = Bench::BestNsPerOp(moved, [&] {
+        for (std::size_t i = 0; i < count; i += 10)
+        {
+            boxes[i].min[0] += 0.2f;
+            boxes[i].max[0] += 0.2f;
+            tree.MoveProxy(proxies[i], boxes[i]);
+        }
+    });
+
+    std::vector<Aabb> stored(count);
+    double storeNs = Bench::BestNsPerOp(moved, [&] {
+        for (std::size_t i = 0; i < count; i += 10)
+        {
+            stored[i] = boxes[i];
+        }
+    });
+
+    // Frustum
+    Frustum const frustum = QueryFrustum();
+
+    SphereSoA spheres;
+    spheres.Resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto const& box = boxes[i];
+        float dx = box.max[0] - box.min[0];
+        float dy = box.max[1] - box.min[1];
+        float dz = box.max[2] - box.min[2];
+        spheres.Set(i, 0.5f * (box.min[0] + box.max[0]), 0.5f * (box.min[1] + box.max[1]), 0.5f * (box.min[2] + box.max[2]),
+            0.5f * std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+
+    std::vector<std::uint32_t> visible;
+    visible.reserve(count);
+
+    double frustumTreeNs = Bench::BestNsPerOp(1, [&] {
+        visible.clear();
+        tree.QueryFrustum(frustum, [&](std::uint32_t index) { visible.push_back(index); });
+    });
+    std::size_t treeVisible = visible.size();
+
+    double frustumBruteNs = Bench::BestNsPerOp(1, [&] {
+        visible.clear();
+        Culling::CullSpheres(frustum, spheres, 0, count, visible);
+    });
+
+    // Rays
+    auto const rays = RandomRays();
+    float const maxDistance = 4.0f * WORLD_HALF_SIZE;
+    std::size_t hits = 0;
+
+    double rayTreeNs = Bench::BestNsPerOp(QUERY_COUNT, [&] {
+        hits = 0;
+        for (auto const& ray : rays)
+        {
+            float closest = maxDistance;
+            bool hit = false;
+
+            tree.RayCast(ray.origin, ray.direction, maxDistance, [&](std::uint32_t index, float) {
+                float entry = boxes[index].RayEntry(ray.origin, ray.inverseDirection, closest);
+                if (entry >= 0.0f)
+                {
+                    closest = entry;
+                    hit = true;
+                }
+                return closest;
+            });
+
+            hits += hit;
+        }
+    });
+
+    double rayBruteNs = Bench::BestNsPerOp(QUERY_COUNT, [&] {
+        for (auto const& ray : rays)
+        {
+            float closest = maxDistance;
+            for (auto const& box : boxes)
+            {
+                float entry = box.RayEntry(ray.origin, ray.inverseDirection, closest);
+                if (entry >= 0.0f)
+                {
+                    closest = entry;
+                }
+            }
+            Bench::DoNotOptimize(closest);
+        }
+    });
+
+    // Ranges
+    float const radius = 20.0f;
+    std::size_t inRange = 0;
+
+    double rangeTreeNs = Bench::BestNsPerOp(QUERY_COUNT, [&] {
+        inRange = 0;
+        for (auto const& ray : rays)
+        {
+            Aabb range;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                range.min[axis] = ray.origin[axis] - radius;
+                range.max[axis] = ray.origin[axis] + radius;
+            }
+
+            tree.QueryAabb(range, [&](std::uint32_t index) {
+                inRange += boxes[index].DistanceSquared(ray.origin) <= radius * radius;
+            });
+        }
+    });
+
+    double rangeBruteNs = Bench::BestNsPerOp(QUERY_COUNT, [&] {
+        std::size_t found = 0;
+        for (auto const& ray : rays)
+        {
+            for (auto const& box : boxes)
+            {
+                found += box.DistanceSquared(ray.origin) <= radius * radius;
+            }
+        }
+        Bench::DoNotOptimize(found);
+    });
+
+    std::printf("%9zu %6d %7.1f %6.1f /%5.1f %9.1f /%9.1f %8.1f /%9.1f %8.1f /%9.1f   %zu/%zu %zu %zu\n",
+        count, tree.Height(), buildNs, updateNs, storeNs,
+        frustumTreeNs / 1000.0, frustumBruteNs / 1000.0,
+        rayTreeNs / 1000.0, rayBruteNs / 1000.0,
+        rangeTreeNs / 1000.0, rangeBruteNs / 1000.0,
+        treeVisible, visible.size(), hits, inRange);
+}
+
+}
+
+
+int main()
+{
+    Bench::PrintHeader("Dynamic AABB tree vs brute force",
+        "    boxes height   build  update/store   frustum us tree/brute   ray us tree/brute  range us tree/brute   visible tree/brute, ray hits, in range");
+
+    for (std::size_t count : {10'000u, 100'000u, 1'000'000u})
+    {
+        Row(count);
+    }
+
+    return 0;
+}
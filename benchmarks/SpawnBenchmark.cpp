@@ -0,0 +1,135 @@
+// Spawning a Transform+Renderable scene one entity at a time (CreateEntity + AddComponent) vs the
+// batch API (CreateEntities + AddComponents), with two systems interested in the result.
+
+#include "BenchmarkUtils.h"
+#include "core/Mediator.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+
+namespace {
+
+struct Vec3
+{
+    float x, y, z;
+};
+
+struct BenchTransform
+{
+    Vec3 position{};
+    Vec3 rotation{};
+    Vec3 scale{1.0f, 1.0f, 1.0f};
+    Vec3 forward{0.0f, 0.0f, 1.0f};
+    Vec3 up{0.0f, 1.0f, 0.0f};
+};
+
+struct BenchRenderable
+{
+    std::shared_ptr<int> model;
+    Vec3 color{};
+};
+
+
+class RenderWorkload : public System
+{
+public:
+    void Init() override {}
+    void Update(float) override {}
+};
+
+class TransformWorkload : public System
+{
+public:
+    void Init() override {}
+    void Update(float) override {}
+};
+
+
+void SetUp(Mediator& mediator, std::size_t count, ComponentStorage storage)
+{
+    mediator.Init(static_cast<EntityIndex>(count), storage);
+    mediator.RegisterComponent<BenchTransform>();
+    mediator.RegisterComponent<BenchRenderable>();
+
+    Signature signature;
+    signature.set(mediator.GetComponentType<BenchTransform>());
+    mediator.RegisterSystem<TransformWorkload>();
+    mediator.SetSystemSignature<TransformWorkload>(signature);
+
+    signature.set(mediator.GetComponentType<BenchRenderable>());
+    mediator.RegisterSystem<RenderWorkload>();
+    mediator.SetSystemSignature<RenderWorkload>(signature);
+}
+
+// Only the spawning is timed; the Mediator is set up (and the previous one torn down) beforehand
+double SpawnOneByOne(std::size_t count, ComponentStorage storage)
+{
+    auto model = std::make_shared<int>(0);
+    std::unique_ptr<Mediator> mediator;
+
+    double ns = Bench::BestNsPerOp(1, [&] {
+        mediator = std::make_unique<Mediator>();
+        SetUp(*mediator, count, storage);
+    }, [&] {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Entity entity = mediator->CreateEntity();
+            float f = static_cast<float>(i);
+
+            mediator->AddComponent(entity, BenchTransform{.position = {f, f, f}});
+            mediator->AddComponent(entity, BenchRenderable{.model = model, .color = {f, f, f}});
+        }
+    });
+
+    return ns / 1e6;
+}
+
+double SpawnBatched(std::size_t count, ComponentStorage storage)
+{
+    auto model = std::make_shared<int>(0);
+    std::unique_ptr<Mediator> mediator;
+    std::vector<Entity> entities;
+    std::vector<BenchTransform> transforms;
+    std::vector<BenchRenderable> renderables;
+
+    double ns = Bench::BestNsPerOp(1, [&] {
+        mediator = std::make_unique<Mediator>();
+        SetUp(*mediator, count, storage);
+        entities.clear();
+        transforms.assign(count, BenchTransform{});
+        renderables.assign(count, BenchRenderable{});
+    }, [&] {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float f = static_cast<float>(i);
+
+            transforms[i] = BenchTransform{.position = {f, f, f}};
+            renderables[i] = BenchRenderable{.model = model, .color = {f, f, f}};
+        }
+
+        mediator->CreateEntities(count, entities);
+        mediator->AddComponents<BenchTransform, BenchRenderable>(entities, transforms, renderables);
+    });
+
+    return ns / 1e6;
+}
+
+}
+
+
+int main()
+{
+    Bench::PrintHeader("Spawn Transform+Renderable entities (ms)", "entities  sparse single  sparse batch  arch single  arch batch");
+
+    for (std::size_t count : {5'000u, 100'000u, 1'000'000u})
+    {
+        std::printf("%8zu %14.2f %13.2f %12.2f %11.2f\n",
+            count,
+            SpawnOneByOne(count, ComponentStorage::Sparse), SpawnBatched(count, ComponentStorage::Sparse),
+            SpawnOneByOne(count, ComponentStorage::Archetype), SpawnBatched(count, ComponentStorage::Archetype));
+    }
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Sparse (one array per component) vs archetype (one table per signature) storage on the
+// RenderSystem workload: walk every Transform+Renderable entity and build its model matrix.
+// The component structs mirror Transform/Renderable's layout without pulling in glm or GL.
+
+#include "BenchmarkUtils.h"
+#include "core/Mediator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+
+namespace {
+
+struct Vec3
+{
+    float x, y, z;
+};
+
+struct BenchTransform
+{
+    Vec3 position{};
+    Vec3 rotation{};
+    Vec3 scale{1.0f, 1.0f, 1.0f};
+    Vec3 forward{0.0f, 0.0f, 1.0f};
+    Vec3 up{0.0f, 1.0f, 0.0f};
+};
+
+struct BenchRenderable
+{
+    std::shared_ptr<int> model;
+    Vec3 color{};
+};
+
+// Components that split the scene into several archetypes
+struct Velocity
+{
+    Vec3 value{};
+};
+
+struct Tag
+{
+    int value{};
+};
+
+struct Matrix
+{
+    float m[16];
+};
+
+
+class RenderWorkload : public System
+{
+public:
+    void Init() override {}
+    void Update(float) override {}
+};
+
+
+// translate * scale * rotY, as RenderSystem builds it
+inline Matrix ModelMatrix(BenchTransform const& transform)
+{
+    float c = std::cos(transform.rotation.y);
+    float s = std::sin(transform.rotation.y);
+    Vec3 const& p = transform.position;
+    Vec3 const& k = transform.scale;
+
+    return Matrix{{
+        k.x * c, 0.0f, k.z * s, 0.0f,
+        0.0f, k.y, 0.0f, 0.0f,
+        -k.x * s, 0.0f, k.z * c, 0.0f,
+        p.x, p.y, p.z, 1.0f
+    }};
+}
+
+
+struct Scene
+{
+    Mediator mediator;
+    std::shared_ptr<RenderWorkload> system;
+    std::vector<Matrix> matrices;
+    double buildNsPerEntity{};
+};
+
+std::unique_ptr<Scene> BuildScene(std::size_t count, ComponentStorage storage)
+{
+    auto scene = std::make_unique<Scene>();
+    auto& mediator = scene->mediator;
+
+    mediator.Init(static_cast<EntityIndex>(count), storage);
+    mediator.RegisterComponent<BenchTransform>();
+    mediator.RegisterComponent<BenchRenderable>();
+    mediator.RegisterComponent<Velocity>();
+    mediator.RegisterComponent<Tag>();
+
+    scene->system = mediator.RegisterSystem<RenderWorkload>();
+    Signature signature;
+    signature.set(mediator.GetComponentType<BenchTransform>());
+    signature.set(mediator.GetComponentType<BenchRenderable>());
+    mediator.SetSystemSignature<RenderWorkload>(signature);
+
+    auto model = std::make_shared<int>(0);
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Entity entity = mediator.CreateEntity();
+        float f = static_cast<float>(i);
+
+        mediator.AddComponent(entity, BenchTransform{.position = {f, f, f}, .rotation = {0.0f, f * 0.01f, 0.0f}});
+
+        // One in eight entities is not rendered at all
+        if (i % 8 != 0) mediator.AddComponent(entity, BenchRenderable{.model = model, .color = {f, f, f}});
+        if (i % 3 == 0) mediator.AddComponent(entity, Velocity{});
+        if (i % 5 == 0) mediator.AddComponent(entity, Tag{});
+    }
+
+    auto stopTime = std::chrono::high_resolution_clock::now();
+    scene->buildNsPerEntity = std::chrono::duration<double, std::nano>(stopTime - startTime).count() / count;
+    scene->matrices.resize(count);
+
+    return scene;
+}
+
+double PerEntityLookups(Scene& scene)
+{
+    return Bench::BestNsPerOp(scene.system->mEntities.Size(), [&] {
+        std::size_t i = 0;
+
+        for (auto const& entity : scene.system->mEntities)
+        {
+            auto const& transform = scene.mediator.GetComponent<BenchTransform>(entity);
+            auto const& renderable = scene.mediator.GetComponent<BenchRenderable>(entity);
+
+            Matrix matrix = ModelMatrix(transform);
+            matrix.m[3] = renderable.color.x;
+            scene.matrices[i++] = matrix;
+        }
+    });
+}
+
+double ViewEach(Scene& scene)
+{
+    return Bench::BestNsPerOp(scene.system->mEntities.Size(), [&] {
+        std::size_t i = 0;
+
+        scene.mediator.Each<BenchTransform const, BenchRenderable const>(
+            [&](BenchTransform const& transform, BenchRenderable const& renderable) {
+                Matrix matrix = ModelMatrix(transform);
+                matrix.m[3] = renderable.color.x;
+                scene.matrices[i++] = matrix;
+            });
+    });
+}
+
+double ArchetypeColumns(Scene& scene)
+{
+    Signature signature;
+    signature.set(scene.mediator.GetComponentType<BenchTransform>());
+    signature.set(scene.mediator.GetComponentType<BenchRenderable>());
+
+    ComponentType transformType = scene.mediator.GetComponentType<BenchTransform>();
+    ComponentType renderableType = scene.mediator.GetComponentType<BenchRenderable>();
+
+    return Bench::BestNsPerOp(scene.system->mEntities.Size(), [&] {
+        std::size_t i = 0;
+
+        scene.mediator.ForEachArchetype(signature, [&](Archetype& archetype) {
+            auto const* transforms = archetype.ColumnData<BenchTransform>(transformType);
+            auto const* renderables = archetype.ColumnData<BenchRenderable>(renderableType);
+
+            for (std::size_t row = 0; row < archetype.Size(); ++row)
+            {
+                Matrix matrix = ModelMatrix(transforms[row]);
+                matrix.m[3] = renderables[row].color.x;
+                scene.matrices[i++] = matrix;
+            }
+        });
+    });
+}
+
+}
+
+
+int main()
+{
+    Bench::PrintHeader("RenderSystem workload (ns/entity)", "entities   sparse build   arch build  sparse get  sparse view  arch get  arch view  arch columns");
+
+    for (std::size_t count : {5'000u, 100'000u, 1'000'000u})
+    {
+        auto sparse = BuildScene(count, ComponentStorage::Sparse);
+        double sparseGet = PerEntityLookups(*sparse);
+        double sparseView = ViewEach(*sparse);
+        double sparseBuild = sparse->buildNsPerEntity;
+        sparse.reset();
+
+        auto archetype = BuildScene(count, ComponentStorage::Archetype);
+        double archetypeGet = PerEntityLookups(*archetype);
+        double archetypeView = ViewEach(*archetype);
+        double archetypeColumns = ArchetypeColumns(*archetype);
+
+        std::printf("%8zu %14.2f %12.2f %11.2f %12.2f %9.2f %10.2f %13.2f\n",
+            count, sparseBuild, archetype->buildNsPerEntity, sparseGet, sparseView, archetypeGet, archetypeView,
+            archetypeColumns);
+    }
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+// World-matrix generation for N transforms, the CPU half of RenderSystem. Compares:
+//  - per entity matrix products: rotateY, translate and scale built as 4x4 matrices and multiplied,
+//    as RenderSystem used to do inside its draw loop
+//  - per entity closed form: the same matrix written directly, scalar sin/cos
+//  - SIMD: TransformMath::WorldMatrices over SoA transforms, with and without the AoS gather
+
+#include "BenchmarkUtils.h"
+#include "graphics/TransformMath.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+struct Vec3
+{
+    float x, y, z;
+};
+
+struct BenchTransform
+{
+    Vec3 position{};
+    Vec3 rotation{};
+    Vec3 scale{1.0f, 1.0f, 1.0f};
+    Vec3 forward{0.0f, 0.0f, 1.0f};
+    Vec3 up{0.0f, 1.0f, 0.0f};
+};
+
+// Column-major, m[column][row] like glm
+struct Mat4
+{
+    float m[4][4]{};
+
+    static Mat4 Identity()
+    {
+        Mat4 result;
+        for (int i = 0; i < 4; ++i)
+        {
+            result.m[i][i] = 1.0f;
+        }
+        return result;
+    }
+};
+
+Mat4 Multiply(Mat4 const& a, Mat4 const& b)
+{
+    Mat4 result;
+
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k)
+            {
+                sum += a.m[k][row] * b.m[column][k];
+            }
+            result.m[column][row] = sum;
+        }
+    }
+
+    return result;
+}
+
+Mat4 MatrixProducts(BenchTransform const& transform)
+{
+    Mat4 rotY = Mat4::Identity();
+    float c = std::cos(transform.rotation.y);
+    float s = std::sin(transform.rotation.y);
+    rotY.m[0][0] = c;
+    rotY.m[2][0] = -s;
+    rotY.m[0][2] = s;
+    rotY.m[2][2] = c;
+
+    Mat4 translate = Mat4::Identity();
+    translate.m[3][0] = transform.position.x;
+    translate.m[3][1] = transform.position.y;
+    translate.m[3][2] = transform.position.z;
+
+    Mat4 scale = Mat4::Identity();
+    scale.m[0][0] = transform.scale.x;
+    scale.m[1][1] = transform.scale.y;
+    scale.m[2][2] = transform.scale.z;
+
+    return Multiply(Multiply(translate, scale), rotY);
+}
+
+std::vector<BenchTransform> RandomTransforms(std::size_t count)
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(-3.2f, 3.2f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+    std::vector<BenchTransform> transforms(count);
+    for (auto& transform : transforms)
+    {
+        transform.position = {position(generator), position(generator), position(generator)};
+        transform.rotation = {0.0f, angle(generator), 0.0f};
+        transform.scale = {scale(generator), scale(generator), scale(generator)};
+    }
+
+    return transforms;
+}
+
+void Gather(std::vector<BenchTransform> const& transforms, TransformSoA& soa)
+{
+    soa.Clear();
+
+    for (auto const& transform : transforms)
+    {
+        soa.Push(
+            transform.position.x, transform.position.y, transform.position.z, transform.rotation.y,
+            transform.scale.x, transform.scale.y, transform.scale.z);
+    }
+}
+
+void Row(std::size_t count)
+{
+    auto const transforms = RandomTransforms(count);
+    std::vector<Mat4> products(count);
+    std::vector<float> matrices(16 * count);
+
+    TransformSoA soa;
+    soa.Reserve(count);
+    Gather(transforms, soa);
+
+    double productsNs = Bench::BestNsPerOp(count, [&] {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            products[i] = MatrixProducts(transforms[i]);
+        }
+    });
+
+    double closedFormNs = Bench::BestNsPerOp(count, [&] {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const& transform = transforms[i];
+            TransformMath::WorldMatrix(
+                transform.position.x, transform.position.y, transform.position.z, transform.rotation.y,
+                transform.scale.x, transform.scale.y, transform.scale.z, &matrices[16 * i]);
+        }
+    });
+
+    double simdNs = Bench::BestNsPerOp(count, [&] {
+        TransformMath::WorldMatrices(soa, matrices.data());
+    });
+
+    double gatherSimdNs = Bench::BestNsPerOp(count, [&] {
+        Gather(transforms, soa);
+        TransformMath::WorldMatrices(soa, matrices.data());
+    });
+
+    // Largest difference from the reference products, so a fast but wrong kernel shows up
+    float maxError = 0.0f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        for (int element = 0; element < 16; ++element)
+        {
+            maxError = std::max(maxError, std::fabs(products[i].m[element / 4][element % 4] - matrices[16 * i + element]));
+        }
+    }
+
+    std::printf("%9zu %10.2f %12.2f %8.2f %14.2f %10.1e\n", count, productsNs, closedFormNs, simdNs, gatherSimdNs, maxError);
+}
+
+}
+
+
+int main()
+{
+    std::printf("\nSIMD lanes: %zu\n", TransformMath::LANES);
+    Bench::PrintHeader("World matrices (ns/transform)", "transforms   products  closed form     simd  gather + simd  max error");
+
+    for (std::size_t count : {10'000u, 100'000u, 1'000'000u})
+    {
+        Row(count);
+    }
+
+    return 0;
+}
@@ -4,20 +4,34 @@
 layout (location = 0) in vec3 aPosition; // Vertex position
 layout (location = 1) in vec3 aNormal;   // Vertex normal
 layout (location = 2) in vec2 aTexCoord; // Texture coordinates
+layout (location = 3) in mat4 aModel;    // Per-instance model matrix (locations 3-6)
+layout (location = 7) in vec4 aColor;    // Per-instance color
 
-uniform mat4 uModel;      // Model matrix
-uniform mat4 uView;       // View matrix
-uniform mat4 uProj;       // Projection matrix
+// Per-frame data, uploaded once per frame by RenderSystem (binding 0)
+layout (std140) uniform FrameData
+{
+    mat4 uView;              // View matrix
+    mat4 uProj;              // Projection matrix
+    vec4 uViewPos;           // Camera position in world space
+    vec4 uLightPos;          // Light position in world space
+    vec4 uLightColor;
+    vec4 uAmbientColor;
+    vec4 uLightAttenuation;
+    float uSpecularStrength;
+    float uSpecularPower;
+};
 
 out vec3 vFragPos;       // Fragment position in world space
 out vec3 vNormal;        // Normal vector in world space
 out vec2 vTexCoord;      // Pass texture coordinates to fragment shader
+out vec3 vColor;         // Instance color
 
 void main()
 {
-    vFragPos = vec3(uModel * vec4(aPosition, 1.0));
+    vFragPos = vec3(aModel * vec4(aPosition, 1.0));
     vNormal = aNormal;
     vTexCoord = aTexCoord;
+    vColor = aColor.rgb;
 
     gl_Position = uProj * uView * vec4(vFragPos, 1.0);
 }
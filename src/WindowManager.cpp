@@ -26,10 +26,7 @@ void windowMouseCallBack(GLFWwindow* window, double xpos, double ypos) {
 	double yoffset = windowManager->mLastMouseY - ypos;
 
 	if(xoffset != 0 || yoffset != 0) {
-		Event event(Events::Window::MOUSEMOVE);
-		event.SetParam(Events::Window::Input::MOUSE_XOFFSET, xoffset);
-		event.SetParam(Events::Window::Input::MOUSE_YOFFSET, yoffset);
-		gMediator.SendEvent(event);
+		gMediator.SendEvent(Events::Window::MouseMove{xoffset, yoffset});
 	}
 
 	windowManager->mLastMouseX = xpos;
@@ -43,10 +40,18 @@ void windowMouseCallBack(GLFWwindow* window, double xpos, double ypos) {
 // TODO: Return error to caller
 bool WindowManager::Init(
 	std::string const& windowTitle, unsigned int windowWidth, unsigned int windowHeight, unsigned int windowPositionX,
-	unsigned int windowPositionY)
+	unsigned int windowPositionY, bool visible)
 {
 	glfwInit();
 
+	// Hints only apply to windows created after them
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+	glfwWindowHint(GLFW_FOCUSED, GLFW_TRUE);
+	glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
 	mWindow = glfwCreateWindow(windowWidth, windowHeight, windowTitle.c_str(), NULL, NULL);
 
 	if (!mWindow) {
@@ -55,12 +60,6 @@ bool WindowManager::Init(
 		return false;
 	}
 
-	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
-	glfwWindowHint(GLFW_FOCUSED, GLFW_TRUE);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
 	// Create OpenGL Context
 	glfwMakeContextCurrent(mWindow);
 
@@ -111,7 +110,7 @@ void WindowManager::ProcessEvents()
 
 	if (glfwGetKey(mWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 	{
-		gMediator.SendEvent(Events::Window::QUIT);
+		gMediator.SendEvent(Events::Window::Quit{});
 	}
 
 	std::bitset<8> currentButtons;
@@ -132,9 +131,7 @@ void WindowManager::ProcessEvents()
 	if (currentButtons != mButtons)
 	{
 		mButtons = currentButtons;
-		Event event(Events::Window::KEYDOWN);
-		event.SetParam(Events::Window::Input::KEYS_DOWN, mButtons);
-		gMediator.SendEvent(event);
+		gMediator.SendEvent(Events::Window::KeyDown{mButtons});
 	}
 }
 
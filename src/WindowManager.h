@@ -11,7 +11,7 @@ class WindowManager
 public:
 	bool Init(
 		std::string const& windowTitle, unsigned int windowWidth, unsigned int windowHeight,
-		unsigned int windowPositionX, unsigned int windowPositionY);
+		unsigned int windowPositionX, unsigned int windowPositionY, bool visible = true);
 
 	void Update();
 
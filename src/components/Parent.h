@@ -0,0 +1,16 @@
+#pragma once
+
+#include "core/Types.h"
+
+// Makes the entity's Transform relative to another entity's world matrix. The parent needs a
+// WorldMatrix; HierarchySystem does the propagation.
+//
+// There is no matching Children component: HierarchySystem derives the child lists from the Parent
+// links whenever one changes, so there is only one side of the relationship to keep consistent.
+//
+// The parent must outlive its children. Before destroying a parent, destroy its children or
+// reparent them (change or remove their Parent).
+struct Parent
+{
+    Entity entity = NULL_ENTITY;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// World transform of an entity, derived from its Transform by TransformSystem
+struct WorldMatrix
+{
+    glm::mat4 matrix = glm::mat4(1.0f);
+};
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "Types.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+
+// Type-erased lifetime operations for one component type, enough to move rows between tables
+struct ComponentInfo
+{
+    std::size_t size{};
+    std::size_t alignment{};
+    void (*moveConstruct)(void* destination, void* source){};
+    void (*destroy)(void* object){};
+
+    template<typename T>
+    static ComponentInfo Of()
+    {
+        return ComponentInfo{
+            .size = sizeof(T),
+            .alignment = alignof(T),
+            .moveConstruct = [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+            .destroy = [](void* object) { static_cast<T*>(object)->~T(); }
+        };
+    }
+};
+
+
+// One packed, growable array of a single component type inside an archetype
+class Column
+{
+public:
+    explicit Column(ComponentInfo const* info)
+        : mInfo(info)
+    {}
+
+    Column(Column&& other) noexcept
+        : mInfo(other.mInfo), mData(std::exchange(other.mData, nullptr)), mCapacity(std::exchange(other.mCapacity, 0))
+    {}
+
+    Column(Column const&) = delete;
+    Column& operator=(Column const&) = delete;
+    Column& operator=(Column&&) = delete;
+
+    ~Column()
+    {
+        Free(mData);
+    }
+
+    void* At(std::size_t row) const
+    {
+        return mData + row * mInfo->size;
+    }
+
+    // Moves the constructed rows [0, size) into a larger allocation
+    void Grow(std::size_t size, std::size_t capacity)
+    {
+        auto* data = static_cast<std::byte*>(::operator new(capacity * mInfo->size, std::align_val_t(Alignment())));
+
+        for (std::size_t row = 0; row < size; ++row)
+        {
+            mInfo->moveConstruct(data + row * mInfo->size, At(row));
+            mInfo->destroy(At(row));
+        }
+
+        Free(mData);
+        mData = data;
+        mCapacity = capacity;
+    }
+
+    // Destroys row and moves the last row into its place
+    void SwapRemove(std::size_t row, std::size_t last)
+    {
+        mInfo->destroy(At(row));
+
+        if (row != last)
+        {
+            mInfo->moveConstruct(At(row), At(last));
+            mInfo->destroy(At(last));
+        }
+    }
+
+    void DestroyRows(std::size_t size)
+    {
+        for (std::size_t row = 0; row < size; ++row)
+        {
+            mInfo->destroy(At(row));
+        }
+    }
+
+    ComponentInfo const& Info() const { return *mInfo; }
+    std::size_t Capacity() const { return mCapacity; }
+
+private:
+    ComponentInfo const* mInfo;
+    std::byte* mData{};
+    std::size_t mCapacity{};
+
+
+    std::size_t Alignment() const
+    {
+        return mInfo->alignment > CACHE_LINE_SIZE ? mInfo->alignment : CACHE_LINE_SIZE;
+    }
+
+    void Free(std::byte* data) const
+    {
+        if (data)
+        {
+            ::operator delete(data, std::align_val_t(Alignment()));
+        }
+    }
+};
+
+
+// Table of every entity that has exactly the components in mSignature: one column per component
+// plus the entity owning each row. Iterating a column walks memory linearly.
+class Archetype
+{
+public:
+    static constexpr std::int16_t NO_COLUMN = -1;
+
+    Archetype(Signature signature, std::array<ComponentInfo, MAX_COMPONENTS> const& infos)
+        : mSignature(signature)
+    {
+        mColumnIndices.fill(NO_COLUMN);
+        mAddEdges.fill(nullptr);
+        mRemoveEdges.fill(nullptr);
+
+        signature.ForEachSetBit([&](std::size_t type) {
+            mColumnIndices[type] = static_cast<std::int16_t>(mColumns.size());
+            mColumns.emplace_back(&infos[type]);
+            mTypes.push_back(static_cast<ComponentType>(type));
+
+            // Smallest row step that starts every column on a fresh cache line
+            mCacheLineRows = std::lcm(mCacheLineRows, CACHE_LINE_SIZE / std::gcd(CACHE_LINE_SIZE, infos[type].size));
+        });
+    }
+
+    Archetype(Archetype const&) = delete;
+    Archetype& operator=(Archetype const&) = delete;
+
+    ~Archetype()
+    {
+        for (auto& column : mColumns)
+        {
+            column.DestroyRows(mEntities.size());
+        }
+    }
+
+    // Grows every column to hold at least capacity rows
+    void Reserve(std::size_t capacity)
+    {
+        if (capacity <= mCapacity)
+        {
+            return;
+        }
+
+        mCapacity = capacity;
+
+        for (auto& column : mColumns)
+        {
+            column.Grow(mEntities.size(), mCapacity);
+        }
+
+        mEntities.reserve(mCapacity);
+    }
+
+    // Appends a row whose component slots are left unconstructed for the caller to fill
+    std::size_t AddRow(Entity entity)
+    {
+        if (mEntities.size() == mCapacity)
+        {
+            mCapacity = mCapacity ? mCapacity * 2 : 64;
+
+            for (auto& column : mColumns)
+            {
+                column.Grow(mEntities.size(), mCapacity);
+            }
+        }
+
+        mEntities.push_back(entity);
+        return mEntities.size() - 1;
+    }
+
+    // Swap-and-pop; returns the entity that now occupies row, if one was moved there
+    bool RemoveRow(std::size_t row, Entity& movedEntity)
+    {
+        std::size_t last = mEntities.size() - 1;
+
+        for (auto& column : mColumns)
+        {
+            column.SwapRemove(row, last);
+        }
+
+        bool moved = row != last;
+        if (moved)
+        {
+            mEntities[row] = mEntities[last];
+            movedEntity = mEntities[row];
+        }
+        mEntities.pop_back();
+
+        return moved;
+    }
+
+    bool HasColumn(ComponentType type) const
+    {
+        return mColumnIndices[type] != NO_COLUMN;
+    }
+
+    void* At(ComponentType type, std::size_t row) const
+    {
+        assert(HasColumn(type) && "Archetype has no column for this component.");
+
+        return mColumns[mColumnIndices[type]].At(row);
+    }
+
+    template<typename T>
+    T* ColumnData(ComponentType type) const
+    {
+        assert(HasColumn(type) && "Archetype has no column for this component.");
+
+        return static_cast<T*>(mColumns[mColumnIndices[type]].At(0));
+    }
+
+    Signature GetSignature() const { return mSignature; }
+    std::vector<ComponentType> const& Types() const { return mTypes; }
+    std::vector<Entity> const& Entities() const { return mEntities; }
+    std::size_t Size() const { return mEntities.size(); }
+
+    // Rows that are a multiple of this apart never share a cache line in any column
+    std::size_t CacheLineRows() const { return mCacheLineRows; }
+
+    // Cached neighbours along the archetype graph, filled lazily by the ArchetypeManager
+    Archetype*& AddEdge(ComponentType type) { return mAddEdges[type]; }
+    Archetype*& RemoveEdge(ComponentType type) { return mRemoveEdges[type]; }
+
+private:
+    Signature mSignature{};
+    std::vector<Entity> mEntities{};
+    std::vector<Column> mColumns{};
+    std::vector<ComponentType> mTypes{};
+    std::size_t mCapacity{};
+    std::size_t mCacheLineRows = 1;
+
+    std::array<std::int16_t, MAX_COMPONENTS> mColumnIndices{};
+    std::array<Archetype*, MAX_COMPONENTS> mAddEdges{};
+    std::array<Archetype*, MAX_COMPONENTS> mRemoveEdges{};
+};
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "Archetype.h"
+#include "Types.h"
+#include <array>
+#include <cassert>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+// Table storage backend: every entity lives in the archetype matching its signature, and adding or
+// removing a component moves its row to the neighbouring archetype.
+class ArchetypeManager
+{
+public:
+    template<typename T>
+    void RegisterComponent(ComponentType type)
+    {
+        mComponentInfos[type] = ComponentInfo::Of<T>();
+    }
+
+    template<typename T>
+    void AddComponent(Entity entity, ComponentType type, T component)
+    {
+        auto& record = GetRecord(entity);
+
+        assert(!(record.archetype && record.archetype->HasColumn(type)) && "Component added to same entity more than once.");
+
+        Archetype* destination = record.archetype ? record.archetype->AddEdge(type) : nullptr;
+        if (!destination)
+        {
+            Signature signature = record.archetype ? record.archetype->GetSignature() : Signature{};
+            signature.set(type, true);
+            destination = &GetArchetype(signature);
+
+            if (record.archetype)
+            {
+                record.archetype->AddEdge(type) = destination;
+            }
+        }
+
+        std::size_t row = MoveEntity(entity, record, *destination);
+        new (destination->At(type, row)) T(std::move(component));
+    }
+
+    // Adds one component of every type to each entity, moving it straight to its final archetype.
+    // components[i] belongs to entities[i] and is moved from.
+    template<typename... Ts>
+    void AddComponents(std::span<Entity const> entities, std::array<ComponentType, sizeof...(Ts)> const& types, std::span<Ts>... components)
+    {
+        Signature added;
+        for (ComponentType type : types)
+        {
+            added.set(type, true);
+        }
+
+        // Entities in a batch usually share a source archetype, so resolve the destination once per run
+        Archetype* source = nullptr;
+        Archetype* destination = nullptr;
+
+        for (std::size_t i = 0; i < entities.size(); ++i)
+        {
+            auto& record = GetRecord(entities[i]);
+
+            if (!destination || record.archetype != source)
+            {
+                source = record.archetype;
+
+                Signature signature = source ? source->GetSignature() : Signature{};
+                assert((signature & added).none() && "Component added to same entity more than once.");
+
+                destination = &GetArchetype(signature | added);
+                destination->Reserve(destination->Size() + entities.size() - i);
+            }
+
+            std::size_t row = MoveEntity(entities[i], record, *destination);
+            ConstructRow(*destination, row, types, i, std::index_sequence_for<Ts...>{}, components...);
+        }
+    }
+
+    void RemoveComponent(Entity entity, ComponentType type)
+    {
+        auto& record = GetRecord(entity);
+
+        assert(record.archetype && record.archetype->HasColumn(type) && "Removing non-existent component.");
+
+        Archetype* destination = record.archetype->RemoveEdge(type);
+        if (!destination)
+        {
+            Signature signature = record.archetype->GetSignature();
+            signature.set(type, false);
+            destination = &GetArchetype(signature);
+            record.archetype->RemoveEdge(type) = destination;
+        }
+
+        MoveEntity(entity, record, *destination);
+    }
+
+    template<typename T>
+    T& GetComponent(Entity entity, ComponentType type)
+    {
+        assert(HasRecord(entity) && "Retrieving non-existent component.");
+
+        auto const& record = mRecords[GetEntityIndex(entity)];
+        return *static_cast<T*>(record.archetype->At(type, record.row));
+    }
+
+    bool HasComponent(Entity entity, ComponentType type) const
+    {
+        return HasRecord(entity) && mRecords[GetEntityIndex(entity)].archetype->HasColumn(type);
+    }
+
+    void EntityDestroyed(Entity entity)
+    {
+        if (HasRecord(entity))
+        {
+            auto& record = mRecords[GetEntityIndex(entity)];
+            RemoveRow(record);
+            record = Record{};
+        }
+    }
+
+    // Calls fn(archetype) for every non-empty archetype whose signature includes required
+    template<typename Fn>
+    void ForEachArchetype(Signature required, Fn&& fn)
+    {
+        for (auto* archetype : mArchetypeList)
+        {
+            if (archetype->Size() != 0 && archetype->GetSignature().Includes(required))
+            {
+                fn(*archetype);
+            }
+        }
+    }
+
+private:
+    struct Record
+    {
+        Archetype* archetype{};
+        std::size_t row{};
+    };
+
+    std::array<ComponentInfo, MAX_COMPONENTS> mComponentInfos{};
+    std::unordered_map<Signature, std::unique_ptr<Archetype>> mArchetypes{};
+    std::vector<Archetype*> mArchetypeList{};
+    std::vector<Record> mRecords{};
+
+
+    // Records are indexed by entity index; the entity manager guarantees handles are alive
+    Record& GetRecord(Entity entity)
+    {
+        EntityIndex index = GetEntityIndex(entity);
+
+        if (index >= mRecords.size())
+        {
+            mRecords.resize(index + 1);
+        }
+
+        return mRecords[index];
+    }
+
+    bool HasRecord(Entity entity) const
+    {
+        EntityIndex index = GetEntityIndex(entity);
+
+        return index < mRecords.size() && mRecords[index].archetype;
+    }
+
+    Archetype& GetArchetype(Signature signature)
+    {
+        auto& archetype = mArchetypes[signature];
+
+        if (!archetype)
+        {
+            archetype = std::make_unique<Archetype>(signature, mComponentInfos);
+            mArchetypeList.push_back(archetype.get());
+        }
+
+        return *archetype;
+    }
+
+    // Moves the shared components into a new row of destination and returns it. Components the
+    // destination lacks are destroyed; ones it adds are left for the caller to construct.
+    std::size_t MoveEntity(Entity entity, Record& record, Archetype& destination)
+    {
+        std::size_t row = destination.AddRow(entity);
+
+        if (record.archetype)
+        {
+            Archetype& source = *record.archetype;
+
+            for (ComponentType type : source.Types())
+            {
+                if (destination.HasColumn(type))
+                {
+                    mComponentInfos[type].moveConstruct(destination.At(type, row), source.At(type, record.row));
+                }
+            }
+
+            RemoveRow(record);
+        }
+
+        record = Record{&destination, row};
+
+        return row;
+    }
+
+    template<typename... Ts, std::size_t... Is>
+    static void ConstructRow(Archetype& archetype, std::size_t row, std::array<ComponentType, sizeof...(Ts)> const& types,
+        std::size_t index, std::index_sequence<Is...>, std::span<Ts>... components)
+    {
+        (new (archetype.At(types[Is], row)) Ts(std::move(components[index])), ...);
+    }
+
+    void RemoveRow(Record const& record)
+    {
+        Entity movedEntity;
+
+        if (record.archetype->RemoveRow(record.row, movedEntity))
+        {
+            mRecords[GetEntityIndex(movedEntity)].row = record.row;
+        }
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Types.h"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+
+using ChangeVersion = std::uint32_t;
+
+
+// Change detection for one component type: a version per entity slot, stamped from a shared clock
+// whenever the component is written (added, fetched non-const, or visited by a non-const view).
+//
+// A reader keeps the version the clock returned when it last advanced it and asks which entities
+// changed since then; every write after that point carries a larger version. Stamping is a plain
+// store to the entity's own slot, so concurrent writers of different entities never share state.
+class ChangeTracker
+{
+public:
+    ChangeTracker(std::atomic<ChangeVersion> const& clock, EntityIndex maxEntities)
+        : mClock(clock), mVersions(maxEntities, clock.load(std::memory_order_relaxed))
+    {}
+
+    void MarkChanged(Entity entity)
+    {
+        assert(GetEntityIndex(entity) < mVersions.size() && "Entity out of range.");
+
+        mVersions[GetEntityIndex(entity)] = mClock.load(std::memory_order_relaxed);
+    }
+
+    // True if entity's component was written after the reader's clock read returned since
+    bool ChangedSince(Entity entity, ChangeVersion since) const
+    {
+        assert(GetEntityIndex(entity) < mVersions.size() && "Entity out of range.");
+
+        return mVersions[GetEntityIndex(entity)] > since;
+    }
+
+private:
+    std::atomic<ChangeVersion> const& mClock;
+    std::vector<ChangeVersion> mVersions;
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "SparseSet.h"
+#include "TypeIndex.h"
+#include "Types.h"
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+
+class Mediator;
+
+
+// Entity that will be created when its command buffer is played back
+struct PendingEntity
+{
+    std::uint32_t index{};
+};
+
+
+// Recorded commands target either an existing entity or a pending one from the same buffer
+struct CommandTarget
+{
+    Entity entity{};
+    bool pending{};
+};
+
+
+// Entities whose signature changed during playback, each with the signature it had before
+class TouchedEntities
+{
+public:
+    bool Contains(Entity entity) const { return mEntities.Contains(entity); }
+
+    void Insert(Entity entity, Signature previous)
+    {
+        mEntities.Insert(entity);
+        mPrevious.push_back(previous);
+    }
+
+    // Returns the signature the entity had before playback
+    Signature Remove(Entity entity)
+    {
+        std::size_t index = mEntities.Remove(entity);
+        Signature previous = mPrevious[index];
+
+        mPrevious[index] = mPrevious.back();
+        mPrevious.pop_back();
+
+        return previous;
+    }
+
+    void Clear()
+    {
+        mEntities.Clear();
+        mPrevious.clear();
+    }
+
+    std::size_t Size() const { return mEntities.Size(); }
+    Entity At(std::size_t index) const { return mEntities.At(index); }
+    Signature Previous(std::size_t index) const { return mPrevious[index]; }
+
+private:
+    SparseSet mEntities{};
+    std::vector<Signature> mPrevious{};
+};
+
+
+class ICommandList
+{
+public:
+    virtual ~ICommandList() = default;
+
+    // Applies the commands to storage and entity signatures, adding every entity whose signature
+    // changed to touched. System membership is left to the caller.
+    virtual void Playback(Mediator& mediator, std::vector<Entity> const& created, TouchedEntities& touched) = 0;
+};
+
+
+// Adds and removes of one component type, in recording order
+template<typename T>
+class CommandList : public ICommandList
+{
+public:
+    void Add(CommandTarget target, T component)
+    {
+        mCommands.push_back(Command{target, std::move(component)});
+    }
+
+    void Remove(CommandTarget target)
+    {
+        mCommands.push_back(Command{target, std::nullopt});
+    }
+
+    bool Empty() const { return mCommands.empty(); }
+
+    // Defined in Mediator.h, where the Mediator is complete
+    void Playback(Mediator& mediator, std::vector<Entity> const& created, TouchedEntities& touched) override;
+
+private:
+    struct Command
+    {
+        CommandTarget target;
+        std::optional<T> component;  // Empty for a remove
+    };
+
+    std::vector<Command> mCommands{};
+};
+
+
+// Records structural changes (create, destroy, add, remove) so they can be made while systems are
+// iterating or from worker threads. Every thread gets its own buffer from
+// Mediator::GetCommandBuffer(); Mediator::FlushCommandBuffers() plays them all back at a sync point.
+//
+// Playback is batched rather than replayed in order: pending entities are created first, then the
+// commands of each component type are applied together (sorted by entity, recording order kept per
+// entity), then destroyed entities are removed. Systems see each touched entity once, with its final
+// signature.
+class CommandBuffer
+{
+public:
+    PendingEntity CreateEntity()
+    {
+        return PendingEntity{mCreateCount++};
+    }
+
+    void DestroyEntity(Entity entity)
+    {
+        mDestroyed.push_back(entity);
+    }
+
+    template<typename T>
+    void AddComponent(Entity entity, T component)
+    {
+        GetList<T>().Add(CommandTarget{entity, false}, std::move(component));
+    }
+
+    template<typename T>
+    void AddComponent(PendingEntity entity, T component)
+    {
+        assert(entity.index < mCreateCount && "Pending entity from another command buffer.");
+
+        GetList<T>().Add(CommandTarget{entity.index, true}, std::move(component));
+    }
+
+    template<typename T>
+    void RemoveComponent(Entity entity)
+    {
+        GetList<T>().Remove(CommandTarget{entity, false});
+    }
+
+    bool Empty() const
+    {
+        return mCreateCount == 0 && mDestroyed.empty() && mUsedLists.empty();
+    }
+
+private:
+    friend class Mediator;
+
+    std::uint32_t mCreateCount{};
+    std::vector<Entity> mDestroyed{};
+
+    // Indexed by TypeIndex<ComponentFamily>; mUsedLists holds the ones with pending commands
+    std::vector<std::unique_ptr<ICommandList>> mLists{};
+    std::vector<std::size_t> mUsedLists{};
+
+
+    template<typename T>
+    CommandList<T>& GetList()
+    {
+        std::size_t index = TypeIndex<ComponentFamily>::Get<T>();
+
+        if (index >= mLists.size())
+        {
+            mLists.resize(index + 1);
+        }
+
+        if (!mLists[index])
+        {
+            mLists[index] = std::make_unique<CommandList<T>>();
+        }
+
+        auto& list = static_cast<CommandList<T>&>(*mLists[index]);
+        if (list.Empty())
+        {
+            mUsedLists.push_back(index);
+        }
+
+        return list;
+    }
+};
@@ -1,9 +1,15 @@
 #pragma once
 
+#include "SparseSet.h"
 #include "Types.h"
-#include <array>
+#include <algorithm>
+#include <bit>
 #include <cassert>
-#include <unordered_map>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
 
 
 class IComponentArray
@@ -11,63 +17,175 @@ class IComponentArray
 public:
     virtual ~IComponentArray() = default;
     virtual void EntityDestroyed(Entity entity) = 0;
+    virtual void EntitiesDestroyed(std::span<Entity const> entities) = 0;
 };
 
 
+// Packed component storage. Components live in fixed-size heap chunks that are allocated as the
+// array grows and released as it shrinks, so references stay valid when other entities are added
+// and memory follows the number of live components.
 template<typename T>
 class ComponentArray : public IComponentArray
 {
 public:
+    // Roughly 16 KiB per chunk, rounded down to a power of two so indexing is a shift and a mask
+    static constexpr size_t CHUNK_SIZE = std::bit_floor(std::max<size_t>(1, 16384 / sizeof(T)));
+
+    ComponentArray() = default;
+    ComponentArray(ComponentArray const&) = delete;
+    ComponentArray& operator=(ComponentArray const&) = delete;
+
+    ~ComponentArray() override
+    {
+        for (size_t index = 0; index < mEntities.Size(); ++index)
+        {
+            GetDataAt(index).~T();
+        }
+    }
+
     void InsertData(Entity entity, T component)
     {
-        assert(mEntityToIndexMap.find(entity) == mEntityToIndexMap.end() && "Component added to same entity more than once.");
+        assert(!mEntities.Contains(entity) && "Component added to same entity more than once.");
 
         // Put new entry at end
-        size_t newIndex = mSize;
-        mEntityToIndexMap[entity] = newIndex;
-        mIndexToEntityMap[newIndex] = entity;
-        mComponentArray[newIndex] = component;
-        ++mSize;
+        size_t newIndex = mEntities.Size();
+        if (newIndex == mChunks.size() * CHUNK_SIZE)
+        {
+            mChunks.push_back(AllocateChunk());
+        }
+
+        new (&GetDataAt(newIndex)) T(std::move(component));
+        mEntities.Insert(entity);
     }
 
     void RemoveData(Entity entity)
     {
-        assert(mEntityToIndexMap.find(entity) != mEntityToIndexMap.end() && "Removing non-existent component.");
-
-        // Copy element at end into deleted element's place to maintain density
-        size_t indexOfRemovedEntity = mEntityToIndexMap[entity];
-        size_t indexOfLastElement = mSize - 1;
-        mComponentArray[indexOfRemovedEntity] = mComponentArray[indexOfLastElement];
+        assert(mEntities.Contains(entity) && "Removing non-existent component.");
 
-        // Update map to point to moved spot
-        Entity entityOfLastElement = mIndexToEntityMap[indexOfLastElement];
-        mEntityToIndexMap[entityOfLastElement] = indexOfRemovedEntity;
-        mIndexToEntityMap[indexOfRemovedEntity] = entityOfLastElement;
+        // Move element at end into deleted element's place to maintain density
+        size_t indexOfRemovedEntity = mEntities.IndexOf(entity);
+        size_t indexOfLastElement = mEntities.Size() - 1;
+        if (indexOfRemovedEntity != indexOfLastElement)
+        {
+            GetDataAt(indexOfRemovedEntity) = std::move(GetDataAt(indexOfLastElement));
+        }
+        GetDataAt(indexOfLastElement).~T();
 
-        mEntityToIndexMap.erase(entity);
-        mIndexToEntityMap.erase(indexOfLastElement);
+        mEntities.Remove(entity);
 
-        --mSize;
+        // Keep one spare chunk around so add/remove at a chunk boundary doesn't thrash the allocator
+        if (mChunks.size() >= 2 && mEntities.Size() + 2 * CHUNK_SIZE <= mChunks.size() * CHUNK_SIZE)
+        {
+            mChunks.pop_back();
+        }
     }
 
     T& GetData(Entity entity)
     {
-        assert(mEntityToIndexMap.find(entity) != mEntityToIndexMap.end() && "Retrieving non-existent component.");
+        assert(mEntities.Contains(entity) && "Retrieving non-existent component.");
+
+        return GetDataAt(mEntities.IndexOf(entity));
+    }
 
-        return mComponentArray[mEntityToIndexMap[entity]];
+    bool HasData(Entity entity) const
+    {
+        return mEntities.Contains(entity);
     }
 
     void EntityDestroyed(Entity entity) override
     {
-        if (mEntityToIndexMap.find(entity) != mEntityToIndexMap.end())
+        if (mEntities.Contains(entity))
         {
             RemoveData(entity);
         }
     }
 
+    void EntitiesDestroyed(std::span<Entity const> entities) override
+    {
+        for (Entity entity : entities)
+        {
+            if (mEntities.Contains(entity))
+            {
+                RemoveData(entity);
+            }
+        }
+    }
+
+    // Reorders the packed array so the entities of order that have this component come first, in the
+    // same relative order. Iterating order and fetching components then walks memory sequentially.
+    void SortAs(SparseSet const& order)
+    {
+        size_t position = 0;
+
+        for (Entity entity : order)
+        {
+            if (mEntities.Contains(entity))
+            {
+                size_t index = mEntities.IndexOf(entity);
+
+                if (index != position)
+                {
+                    std::swap(GetDataAt(index), GetDataAt(position));
+                    mEntities.Swap(index, position);
+                }
+
+                ++position;
+            }
+        }
+    }
+
+    void Reserve(size_t capacity)
+    {
+        mEntities.Reserve(capacity);
+
+        while (mChunks.size() * CHUNK_SIZE < capacity)
+        {
+            mChunks.push_back(AllocateChunk());
+        }
+    }
+
+    // Packed view: Entities().At(i) owns GetDataAt(i) for i < Size()
+    SparseSet const& Entities() const { return mEntities; }
+    size_t Size() const { return mEntities.Size(); }
+
+    T& GetDataAt(size_t index)
+    {
+        return mChunks[index / CHUNK_SIZE]->data[index % CHUNK_SIZE].value;
+    }
+
+    // Calls fn(entities, components, count) once per chunk, in dense order
+    template<typename Fn>
+    void ForEachChunk(Fn&& fn)
+    {
+        for (size_t first = 0; first < mEntities.Size(); first += CHUNK_SIZE)
+        {
+            size_t count = std::min(CHUNK_SIZE, mEntities.Size() - first);
+            fn(mEntities.Data() + first, &GetDataAt(first), count);
+        }
+    }
+
 private:
-    std::array<T, MAX_ENTITIES> mComponentArray{};
-    std::unordered_map<Entity, size_t> mEntityToIndexMap{};
-    std::unordered_map<size_t, Entity> mIndexToEntityMap{};
-    size_t mSize{};
+    // Uninitialized slot; lifetime of the value is managed by the array
+    union Slot
+    {
+        Slot() {}
+        ~Slot() {}
+
+        T value;
+    };
+
+    struct alignas(std::max<size_t>(alignof(T), CACHE_LINE_SIZE)) Chunk
+    {
+        Slot data[CHUNK_SIZE];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> mChunks{};
+    SparseSet mEntities{};
+
+
+    static std::unique_ptr<Chunk> AllocateChunk()
+    {
+        // Default-initialized on purpose: slots are constructed on insert
+        return std::unique_ptr<Chunk>(new Chunk);
+    }
 };
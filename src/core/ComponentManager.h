@@ -1,10 +1,15 @@
 #pragma once
 
 #include "ComponentArray.h"
+#include "TypeIndex.h"
 #include "Types.h"
-#include <any>
+#include <array>
+#include <cassert>
+#include <limits>
 #include <memory>
-#include <unordered_map>
+#include <span>
+#include <utility>
+#include <vector>
 
 
 class ComponentManager
@@ -13,12 +18,20 @@ public:
     template<typename T>
     void RegisterComponent()
     {
-        const char* typeName = typeid(T).name();
+        std::size_t index = TypeIndex<ComponentFamily>::Get<T>();
 
-        assert(mComponentTypes.find(typeName) == mComponentTypes.end() && "Registering component type more than once.");
+        if (index >= mComponentTypes.size())
+        {
+            mComponentTypes.resize(index + 1, UNREGISTERED);
+            mComponentArrays.resize(index + 1);
+        }
 
-        mComponentTypes.insert({typeName, mNextComponentType});
-        mComponentArrays.insert({typeName, std::make_shared<ComponentArray<T>>()});
+        assert(mComponentTypes[index] == UNREGISTERED && "Registering component type more than once.");
+        assert(mNextComponentType < MAX_COMPONENTS && "Too many component types registered.");
+
+        mComponentTypes[index] = mNextComponentType;
+        mComponentArrays[index] = std::make_unique<ComponentArray<T>>();
+        mArraysByType[mNextComponentType] = mComponentArrays[index].get();
 
         ++mNextComponentType;
     }
@@ -26,17 +39,26 @@ public:
     template<typename T>
     ComponentType GetComponentType()
     {
-        const char* typeName = typeid(T).name();
-
-        assert(mComponentTypes.find(typeName) != mComponentTypes.end() && "Component not registered before use.");
-
-        return mComponentTypes[typeName];
+        return mComponentTypes[GetIndex<T>()];
     }
 
     template<typename T>
     void AddComponent(Entity entity, T component)
     {
-        GetComponentArray<T>()->InsertData(entity, component);
+        GetComponentArray<T>()->InsertData(entity, std::move(component));
+    }
+
+    // components[i] belongs to entities[i] and is moved from
+    template<typename T>
+    void AddComponents(std::span<Entity const> entities, std::span<T> components)
+    {
+        auto* array = GetComponentArray<T>();
+        array->Reserve(array->Size() + entities.size());
+
+        for (std::size_t i = 0; i < entities.size(); ++i)
+        {
+            array->InsertData(entities[i], std::move(components[i]));
+        }
     }
 
     template<typename T>
@@ -51,29 +73,53 @@ public:
         return GetComponentArray<T>()->GetData(entity);
     }
 
-    void EntityDestroyed(Entity entity)
+    template<typename T>
+    void SortAs(SparseSet const& order)
+    {
+        GetComponentArray<T>()->SortAs(order);
+    }
+
+    template<typename T>
+    ComponentArray<T>* GetComponentArray()
     {
-        for (auto const& pair : mComponentArrays)
-        {
-            auto const& component = pair.second;
+        return static_cast<ComponentArray<T>*>(mComponentArrays[GetIndex<T>()].get());
+    }
 
-            component->EntityDestroyed(entity);
-        }
+    // Only the pools named by the entity's signature are visited
+    void EntityDestroyed(Entity entity, Signature signature)
+    {
+        signature.ForEachSetBit([&](std::size_t type) {
+            mArraysByType[type]->EntityDestroyed(entity);
+        });
+    }
+
+    // used is the union of the entities' signatures
+    void EntitiesDestroyed(std::span<Entity const> entities, Signature used)
+    {
+        used.ForEachSetBit([&](std::size_t type) {
+            mArraysByType[type]->EntitiesDestroyed(entities);
+        });
     }
 
 private:
-    std::unordered_map<const char*, ComponentType> mComponentTypes{};
-    std::unordered_map<const char*, std::shared_ptr<IComponentArray>> mComponentArrays{};
+    static constexpr ComponentType UNREGISTERED = std::numeric_limits<ComponentType>::max();
+
+    // Both indexed by TypeIndex<ComponentFamily>
+    std::vector<ComponentType> mComponentTypes{};
+    std::vector<std::unique_ptr<IComponentArray>> mComponentArrays{};
+
+    // The same arrays, indexed by ComponentType so signature bits map straight to their pool
+    std::array<IComponentArray*, MAX_COMPONENTS> mArraysByType{};
     ComponentType mNextComponentType{};
 
 
     template<typename T>
-    std::shared_ptr<ComponentArray<T>> GetComponentArray()
+    std::size_t GetIndex() const
     {
-        const char* typeName = typeid(T).name();
+        std::size_t index = TypeIndex<ComponentFamily>::Get<T>();
 
-        assert(mComponentTypes.find(typeName) != mComponentTypes.end() && "Component not registered before use.");
+        assert(index < mComponentTypes.size() && mComponentTypes[index] != UNREGISTERED && "Component not registered before use.");
 
-        return std::static_pointer_cast<ComponentArray<T>>(mComponentArrays[typeName]);
+        return index;
     }
 };
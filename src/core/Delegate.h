@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+template<typename Signature>
+class Delegate;
+
+
+// Non-owning, non-allocating callable: a couple of pointers of inline storage plus a thunk that
+// knows how to call through them. Binds a member function to an object, a free function, or a
+// small trivially copyable callable (a lambda capturing a pointer or two). Copying is a memcpy and
+// calling is one indirect call, with no heap and no virtual dispatch.
+template<typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+    static constexpr std::size_t STORAGE_SIZE = 2 * sizeof(void*);
+
+    Delegate() = default;
+
+    // Delegate::Bind<&Class::Method>(object)
+    template<auto Method, typename C>
+    static Delegate Bind(C* object)
+    {
+        Delegate delegate;
+        delegate.Store(object);
+        delegate.mThunk = [](void const* storage, Args... args) -> R {
+            return std::invoke(Method, Load<C*>(storage), std::forward<Args>(args)...);
+        };
+        return delegate;
+    }
+
+    // Delegate::Bind<&Function>()
+    template<auto Function>
+    static Delegate Bind()
+    {
+        Delegate delegate;
+        delegate.mThunk = [](void const*, Args... args) -> R {
+            return std::invoke(Function, std::forward<Args>(args)...);
+        };
+        return delegate;
+    }
+
+    // Anything callable that fits the inline storage and is trivially copyable; whatever it
+    // references must outlive the delegate
+    template<typename F>
+        requires (!std::is_same_v<std::decay_t<F>, Delegate> && std::is_invocable_r_v<R, F const&, Args...>)
+    static Delegate Bind(F&& function)
+    {
+        using Function = std::decay_t<F>;
+
+        static_assert(sizeof(Function) <= STORAGE_SIZE, "Callable too large for a Delegate; capture less or bind a method.");
+        static_assert(std::is_trivially_copyable_v<Function>, "Delegate callables must be trivially copyable.");
+
+        Delegate delegate;
+        delegate.Store(Function(std::forward<F>(function)));
+        delegate.mThunk = [](void const* storage, Args... args) -> R {
+            return std::invoke(Load<Function>(storage), std::forward<Args>(args)...);
+        };
+        return delegate;
+    }
+
+    R operator()(Args... args) const
+    {
+        return mThunk(mStorage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return mThunk != nullptr; }
+
+private:
+    using Thunk = R (*)(void const* storage, Args... args);
+
+    alignas(void*) std::byte mStorage[STORAGE_SIZE]{};
+    Thunk mThunk{};
+
+
+    // Only trivially copyable values are stored, so copying the bytes copies the value
+    template<typename T>
+    void Store(T const& value)
+    {
+        static_assert(alignof(T) <= alignof(void*), "Delegate storage is pointer aligned.");
+
+        new (mStorage) T(value);
+    }
+
+    template<typename T>
+    static T const& Load(void const* storage)
+    {
+        return *std::launder(static_cast<T const*>(storage));
+    }
+};
@@ -1,58 +1,121 @@
 #pragma once
 
 #include "Types.h"
-#include <array>
 #include <cassert>
-#include <queue>
+#include <cstddef>
+#include <limits>
+#include <vector>
 
 
+// Hands out generational entity handles. Every slot stores a handle: a live slot stores exactly the
+// handle that was returned for it, so checking a handle is one compare. A free slot stores the index
+// of the next free slot together with the version its next occupant will get, which threads the
+// free list through the slot array without any extra allocation.
 class EntityManager
 {
 public:
-    EntityManager()
+    explicit EntityManager(EntityIndex maxEntities = MAX_ENTITIES)
+        : mMaxEntities(maxEntities)
+    {}
+
+    Entity CreateEntity()
     {
-        for (Entity entity = 0; entity < MAX_ENTITIES; ++entity)
+        assert(mLivingEntityCount < mMaxEntities && "Too many entities in existence.");
+
+        ++mLivingEntityCount;
+
+        // Recycle destroyed slots first so the index range (and everything indexed by it) stays compact
+        if (mFreeHead != NO_SLOT)
         {
-            mAvailableEntities.push(entity);
+            return Recycle();
         }
+
+        auto const index = static_cast<EntityIndex>(mSlots.size());
+        mSlots.push_back(MakeEntity(index, 0));
+        mSignatures.emplace_back();
+
+        return mSlots.back();
     }
 
-    Entity CreateEntity()
+    // Appends count new entities to out: recycled slots first, then one contiguous block of fresh ones
+    void CreateEntities(std::size_t count, std::vector<Entity>& out)
     {
-        assert(mLivingEntityCount < MAX_ENTITIES && "Too many entities in existence.");
+        assert(mLivingEntityCount + count <= mMaxEntities && "Too many entities in existence.");
 
-        Entity id = mAvailableEntities.front();
-        mAvailableEntities.pop();
-        ++mLivingEntityCount;
+        out.reserve(out.size() + count);
+        mLivingEntityCount += static_cast<EntityIndex>(count);
 
-        return id;
+        for (; count > 0 && mFreeHead != NO_SLOT; --count)
+        {
+            out.push_back(Recycle());
+        }
+
+        auto const first = static_cast<EntityIndex>(mSlots.size());
+        mSlots.reserve(mSlots.size() + count);
+        mSignatures.resize(mSignatures.size() + count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            mSlots.push_back(MakeEntity(first + static_cast<EntityIndex>(i), 0));
+            out.push_back(mSlots.back());
+        }
     }
 
     void DestroyEntity(Entity entity)
     {
-        assert(entity < MAX_ENTITIES && "Entity out of range.");
+        assert(IsAlive(entity) && "Destroying an entity that is not alive.");
+
+        EntityIndex const index = GetEntityIndex(entity);
 
-        mSignatures[entity].reset();
-        mAvailableEntities.push(entity);
+        // The version wraps after 2^32 reuses of one slot
+        mSlots[index] = MakeEntity(mFreeHead, GetEntityVersion(entity) + 1);
+        mFreeHead = index;
+        mSignatures[index].reset();
         --mLivingEntityCount;
     }
 
+    bool IsAlive(Entity entity) const
+    {
+        EntityIndex const index = GetEntityIndex(entity);
+
+        return index < mSlots.size() && mSlots[index] == entity;
+    }
+
     void SetSignature(Entity entity, Signature signature)
     {
-        assert(entity < MAX_ENTITIES && "Entity out of range.");
+        assert(IsAlive(entity) && "Entity is not alive.");
 
-        mSignatures[entity] = signature;
+        mSignatures[GetEntityIndex(entity)] = signature;
     }
 
     Signature GetSignature(Entity entity)
     {
-        assert(entity < MAX_ENTITIES && "Entity out of range.");
+        assert(IsAlive(entity) && "Entity is not alive.");
 
-        return mSignatures[entity];
+        return mSignatures[GetEntityIndex(entity)];
     }
 
+    EntityIndex GetMaxEntities() const { return mMaxEntities; }
+    EntityIndex GetLivingEntityCount() const { return mLivingEntityCount; }
+
 private:
-    std::queue<Entity> mAvailableEntities{};
-    std::array<Signature, MAX_ENTITIES> mSignatures{};
-    uint32_t mLivingEntityCount{};
+    static constexpr EntityIndex NO_SLOT = std::numeric_limits<EntityIndex>::max();
+
+    std::vector<Entity> mSlots{};
+    std::vector<Signature> mSignatures{};
+    EntityIndex mFreeHead = NO_SLOT;
+    EntityIndex mLivingEntityCount{};
+    EntityIndex mMaxEntities{};
+
+
+    // Pops the head of the free list; its slot already holds the version to hand out
+    Entity Recycle()
+    {
+        EntityIndex const index = mFreeHead;
+
+        mFreeHead = GetEntityIndex(mSlots[index]);
+        mSlots[index] = MakeEntity(index, GetEntityVersion(mSlots[index]));
+
+        return mSlots[index];
+    }
 };
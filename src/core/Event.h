@@ -1,37 +1,58 @@
 #pragma once
 
 #include "Types.h"
-#include <any>
-#include <unordered_map>
+#include <bitset>
 
 
-class Event
+// Events are plain structs sent by value. Listeners subscribe to one event type and receive it as a
+// typed reference, so there is no parameter lookup, no casting and nothing to allocate per event.
+// A static Coalesce(last, next) lets a queued event type fold a new event into the previous one
+// (see EventManager); it returns false when the two must stay separate.
+
+namespace Events::Window {
+
+struct Quit
 {
-public:
-    Event() = delete;
+};
 
-    explicit Event(EventId type)
-        : mType(type)
-    {}
+struct Resized
+{
+    unsigned int width{};
+    unsigned int height{};
 
-    template<typename T>
-    void SetParam(EventId id, T value)
+    // Only the final size matters
+    static bool Coalesce(Resized& last, Resized const& next)
     {
-        mData[id] = value;
+        last = next;
+        return true;
     }
+};
+
+// Sent when the set of held InputButtons changes
+struct KeyDown
+{
+    std::bitset<8> buttons{};
 
-    template<typename T>
-    T GetParam(EventId id)
+    // Carries the full button state, so the latest one replaces the rest
+    static bool Coalesce(KeyDown& last, KeyDown const& next)
     {
-        return std::any_cast<T>(mData[id]);
+        last = next;
+        return true;
     }
+};
+
+// Cursor movement since the previous MouseMove, y pointing up
+struct MouseMove
+{
+    double xOffset{};
+    double yOffset{};
 
-    EventId GetType() const
+    static bool Coalesce(MouseMove& last, MouseMove const& next)
     {
-        return mType;
+        last.xOffset += next.xOffset;
+        last.yOffset += next.yOffset;
+        return true;
     }
-
-private:
-    EventId mType{};
-    std::unordered_map<EventId, std::any> mData{};
 };
+
+}
@@ -1,40 +1,396 @@
 #pragma once
 
+#include "Delegate.h"
 #include "Event.h"
+#include "MpmcQueue.h"
+#include "TypeIndex.h"
 #include "Types.h"
-#include <functional>
-#include <list>
-#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
 
 
+// Identifies one subscription so it can be removed again; a default handle refers to nothing
+struct ListenerHandle
+{
+    std::size_t eventType = std::numeric_limits<std::size_t>::max();
+    std::uint32_t slot{};
+    std::uint32_t version{};
+    bool batch{};
+};
+
+
+// Delegates packed in a vector for dispatch, plus a slot array that maps handles to their current
+// position so removal is a swap-and-pop. Removal reorders the remaining listeners. Listeners may be
+// added or removed while the table is dispatching: new ones are first called on the next dispatch,
+// removed ones are skipped and compacted away afterwards.
+template<typename Signature>
+class ListenerTable
+{
+public:
+    ListenerHandle Add(Delegate<Signature> delegate)
+    {
+        std::uint32_t slot;
+
+        if (!mFreeSlots.empty())
+        {
+            slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        }
+        else
+        {
+            slot = static_cast<std::uint32_t>(mSlots.size());
+            mSlots.emplace_back();
+        }
+
+        mSlots[slot].dense = static_cast<std::uint32_t>(mDelegates.size());
+        mDelegates.push_back(delegate);
+        mOwners.push_back(slot);
+
+        return ListenerHandle{.slot = slot, .version = mSlots[slot].version};
+    }
+
+    // False if the handle was already removed
+    bool Remove(ListenerHandle const& handle)
+    {
+        if (handle.slot >= mSlots.size() || mSlots[handle.slot].version != handle.version || mSlots[handle.slot].dense == NONE)
+        {
+            return false;
+        }
+
+        Slot& slot = mSlots[handle.slot];
+        std::uint32_t dense = slot.dense;
+
+        slot.dense = NONE;
+        ++slot.version;
+        mFreeSlots.push_back(handle.slot);
+
+        if (mDispatchDepth > 0)
+        {
+            mDelegates[dense] = {};
+            mOwners[dense] = NONE;
+            mHasHoles = true;
+        }
+        else
+        {
+            Erase(dense);
+        }
+
+        return true;
+    }
+
+    template<typename... Args>
+    void Invoke(Args const&... args)
+    {
+        ++mDispatchDepth;
+
+        std::size_t const count = mDelegates.size();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // Called through a copy: a listener that adds listeners may reallocate the table
+            Delegate<Signature> delegate = mDelegates[i];
+
+            if (delegate)
+            {
+                delegate(args...);
+            }
+        }
+
+        if (--mDispatchDepth == 0 && mHasHoles)
+        {
+            Compact();
+        }
+    }
+
+    bool Empty() const { return mDelegates.empty(); }
+
+private:
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    struct Slot
+    {
+        std::uint32_t dense = NONE;
+        std::uint32_t version{};
+    };
+
+    std::vector<Delegate<Signature>> mDelegates{};
+    std::vector<std::uint32_t> mOwners{};  // Dense index -> slot
+    std::vector<Slot> mSlots{};
+    std::vector<std::uint32_t> mFreeSlots{};
+    std::size_t mDispatchDepth{};
+    bool mHasHoles{};
+
+
+    void Erase(std::uint32_t dense)
+    {
+        mDelegates[dense] = mDelegates.back();
+        mOwners[dense] = mOwners.back();
+
+        if (mOwners[dense] != NONE)
+        {
+            mSlots[mOwners[dense]].dense = dense;
+        }
+
+        mDelegates.pop_back();
+        mOwners.pop_back();
+    }
+
+    void Compact()
+    {
+        for (std::uint32_t i = 0; i < mDelegates.size();)
+        {
+            if (mOwners[i] == NONE)
+            {
+                Erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        mHasHoles = false;
+    }
+};
+
+
+// Listeners are kept per event type, indexed by TypeIndex<EventFamily>, so sending resolves its
+// listener list with one vector index.
+//
+// By default SendEvent calls the listeners immediately. A type switched to queued mode is appended
+// to a per-type buffer instead and delivered by DispatchEvents, once per frame: batch listeners get
+// the whole frame's events as one span, plain listeners get them one by one. Queued types that
+// define a static bool Coalesce(E& last, E const& next) merge consecutive events as they arrive.
+//
+// Every method except PostEvent belongs to the main thread. PostEvent may be called from any thread
+// for a type opened with EnablePosting; it pushes into a bounded lock-free queue that DispatchEvents
+// drains in bulk. Workers find that queue through a fixed array filled in by EnablePosting, never
+// through the channel list, which the main thread may grow at any time.
 class EventManager
 {
 public:
-    void AddListener(EventId eventId, std::function<void(Event&)> const& listener)
+    // Event types are numbered in order of first use; only the first MAX_POSTED_EVENT_TYPES can be posted
+    static constexpr std::size_t MAX_POSTED_EVENT_TYPES = 64;
+
+    template<typename E>
+    ListenerHandle AddListener(Delegate<void(E const&)> listener)
+    {
+        ListenerHandle handle = GetChannel<E>().listeners.Add(listener);
+        handle.eventType = TypeIndex<EventFamily>::Get<E>();
+        return handle;
+    }
+
+    template<typename E>
+    ListenerHandle AddBatchListener(Delegate<void(std::span<E const>)> listener)
+    {
+        ListenerHandle handle = GetChannel<E>().batchListeners.Add(listener);
+        handle.eventType = TypeIndex<EventFamily>::Get<E>();
+        handle.batch = true;
+        return handle;
+    }
+
+    // O(1); removing a listener twice, or through a default handle, does nothing
+    void RemoveListener(ListenerHandle const& handle)
+    {
+        if (handle.eventType < mChannels.size() && mChannels[handle.eventType])
+        {
+            mChannels[handle.eventType]->RemoveListener(handle);
+        }
+    }
+
+    template<typename E>
+    void SetQueued(bool queued = true)
+    {
+        auto& channel = GetChannel<E>();
+
+        if (channel.queued == queued)
+        {
+            return;
+        }
+
+        // Deliver whatever was buffered so switching modes never drops events
+        channel.Dispatch();
+        channel.queued = queued;
+
+        if (queued)
+        {
+            mQueuedChannels.push_back(&channel);
+        }
+        else
+        {
+            std::erase(mQueuedChannels, &channel);
+        }
+    }
+
+    // Lets any thread PostEvent an E. Posted events are delivered by DispatchEvents, so this also
+    // queues E. At most capacity events can wait between two dispatches.
+    template<typename E>
+    void EnablePosting(std::size_t capacity = 1024)
     {
-        listeners[eventId].push_back(listener);
+        std::size_t index = TypeIndex<EventFamily>::Get<E>();
+        auto& channel = GetChannel<E>();
+
+        assert(index < MAX_POSTED_EVENT_TYPES && "Too many event types for posting; raise MAX_POSTED_EVENT_TYPES.");
+        assert(!channel.inbox && "Posting enabled twice for the same event type.");
+
+        channel.inbox = std::make_unique<MpmcQueue<E>>(capacity);
+        mPostingChannels.push_back(&channel);
+        SetQueued<E>();
+
+        mInboxes[index].store(channel.inbox.get(), std::memory_order_release);
+    }
+
+    // Thread safe and lock free. Returns false, dropping the event, when the type's queue is full.
+    template<typename E>
+    bool PostEvent(E const& event)
+    {
+        std::size_t index = TypeIndex<EventFamily>::Get<E>();
+
+        assert(index < MAX_POSTED_EVENT_TYPES && mInboxes[index].load(std::memory_order_relaxed)
+            && "Posting an event type without EnablePosting.");
+
+        return static_cast<MpmcQueue<E>*>(mInboxes[index].load(std::memory_order_acquire))->TryPush(event);
     }
 
-    void SendEvent(Event& event)
+    template<typename E>
+    void SendEvent(E const& event)
     {
-        uint32_t type = event.GetType();
+        auto& channel = GetChannel<E>();
 
-        for (auto const& listener : listeners[type])
+        if (channel.queued)
         {
-            listener(event);
+            channel.Push(event);
+            return;
+        }
+
+        channel.listeners.Invoke(event);
+
+        if (!channel.batchListeners.Empty())
+        {
+            channel.batchListeners.Invoke(std::span<E const>(&event, 1));
         }
     }
 
-    void SendEvent(EventId eventId)
+    // Delivers every queued event, type by type in the order the types were queued. Events sent by
+    // listeners during dispatch are delivered on the next call.
+    void DispatchEvents()
     {
-        Event event(eventId);
+        for (auto* channel : mPostingChannels)
+        {
+            channel->DrainInbox();
+        }
 
-        for (auto const& listener : listeners[eventId])
+        for (auto* channel : mQueuedChannels)
         {
-            listener(event);
+            channel->Dispatch();
         }
     }
 
 private:
-    std::unordered_map<EventId, std::list<std::function<void(Event&)>>> listeners;
+    struct IChannel
+    {
+        virtual ~IChannel() = default;
+        virtual void Dispatch() = 0;
+        virtual void DrainInbox() = 0;
+        virtual void RemoveListener(ListenerHandle const& handle) = 0;
+    };
+
+    template<typename E>
+    struct Channel : IChannel
+    {
+        ListenerTable<void(E const&)> listeners{};
+        ListenerTable<void(std::span<E const>)> batchListeners{};
+        bool queued{};
+
+        // Double buffered: senders append to pending while the previous frame's events dispatch.
+        // Both keep their capacity, so a steady stream of events allocates nothing.
+        std::vector<E> pending{};
+        std::vector<E> dispatching{};
+
+        // Events posted from other threads, moved into pending on the main thread
+        std::unique_ptr<MpmcQueue<E>> inbox{};
+
+        void Push(E const& event)
+        {
+            if constexpr (requires(E& last) { { E::Coalesce(last, event) } -> std::same_as<bool>; })
+            {
+                if (!pending.empty() && E::Coalesce(pending.back(), event))
+                {
+                    return;
+                }
+            }
+
+            pending.push_back(event);
+        }
+
+        void Dispatch() override
+        {
+            if (pending.empty())
+            {
+                return;
+            }
+
+            std::swap(pending, dispatching);
+
+            batchListeners.Invoke(std::span<E const>(dispatching));
+
+            for (E const& event : dispatching)
+            {
+                listeners.Invoke(event);
+            }
+
+            dispatching.clear();
+        }
+
+        void DrainInbox() override
+        {
+            inbox->Drain([this](E& event) { Push(event); });
+        }
+
+        void RemoveListener(ListenerHandle const& handle) override
+        {
+            if (handle.batch)
+            {
+                batchListeners.Remove(handle);
+            }
+            else
+            {
+                listeners.Remove(handle);
+            }
+        }
+    };
+
+    std::vector<std::unique_ptr<IChannel>> mChannels{};
+    std::vector<IChannel*> mQueuedChannels{};
+    std::vector<IChannel*> mPostingChannels{};
+
+    // Type index -> that type's MpmcQueue<E>, set once by EnablePosting and never moved, so PostEvent
+    // can read it from any thread
+    std::array<std::atomic<void*>, MAX_POSTED_EVENT_TYPES> mInboxes{};
+
+
+    template<typename E>
+    Channel<E>& GetChannel()
+    {
+        std::size_t index = TypeIndex<EventFamily>::Get<E>();
+
+        if (index >= mChannels.size())
+        {
+            mChannels.resize(index + 1);
+        }
+
+        if (!mChannels[index])
+        {
+            mChannels[index] = std::make_unique<Channel<E>>();
+        }
+
+        return static_cast<Channel<E>&>(*mChannels[index]);
+    }
 };
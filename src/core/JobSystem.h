@@ -0,0 +1,246 @@
+#pragma once
+
+#include "Types.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Outstanding job count for a batch; JobSystem::Wait returns once it reaches zero
+struct JobCounter
+{
+    std::atomic<std::size_t> remaining{0};
+};
+
+
+// Plain function-pointer job so submitting never allocates. The context must outlive the job.
+struct Job
+{
+    void (*function)(void* context, std::size_t index){};
+    void* context{};
+    std::size_t index{};
+    JobCounter* counter{};
+};
+
+
+// Work-stealing thread pool. Every worker owns a queue: it pushes and pops its own work at the back
+// (LIFO, cache-warm) while idle workers steal from the front of other queues. Threads outside the
+// pool submit into a shared injection queue and help execute jobs while they wait.
+class JobSystem
+{
+public:
+    explicit JobSystem(std::size_t workerCount = DefaultWorkerCount())
+    {
+        // Queue 0 is the injection queue for non-worker threads
+        for (std::size_t i = 0; i <= workerCount; ++i)
+        {
+            mQueues.push_back(std::make_unique<Queue>());
+        }
+
+        for (std::size_t i = 0; i < workerCount; ++i)
+        {
+            mThreads.emplace_back([this, i] { WorkerLoop(i + 1); });
+        }
+    }
+
+    JobSystem(JobSystem const&) = delete;
+    JobSystem& operator=(JobSystem const&) = delete;
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard lock(mSleepMutex);
+            mStop = true;
+        }
+        mWake.notify_all();
+
+        for (auto& thread : mThreads)
+        {
+            thread.join();
+        }
+    }
+
+    static std::size_t DefaultWorkerCount()
+    {
+        // The calling (main) thread helps out, so leave one hardware thread for it
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+
+    std::size_t WorkerCount() const { return mThreads.size(); }
+
+    void Submit(Job const& job)
+    {
+        if (job.counter)
+        {
+            job.counter->remaining.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Count first so a job is never taken before it is counted
+        mPending.fetch_add(1, std::memory_order_release);
+
+        // Full queue: run inline rather than block
+        if (!mQueues[CurrentQueue()]->Push(job))
+        {
+            mPending.fetch_sub(1, std::memory_order_relaxed);
+            Execute(job);
+            return;
+        }
+
+        // Taking the lock orders this wake-up after a sleeping worker's predicate check
+        {
+            std::lock_guard lock(mSleepMutex);
+        }
+        mWake.notify_one();
+    }
+
+    // Runs one pending job on the calling thread, if there is any
+    bool RunPending()
+    {
+        Job job;
+
+        if (!TryTake(CurrentQueue(), job))
+        {
+            return false;
+        }
+
+        Execute(job);
+        return true;
+    }
+
+    // Helps run jobs until every job counted by counter has finished
+    void Wait(JobCounter& counter)
+    {
+        while (counter.remaining.load(std::memory_order_acquire) != 0)
+        {
+            if (!RunPending())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t QUEUE_CAPACITY = 4096;
+
+    // Mutex-guarded ring buffer; padded so neighbouring queues never share a cache line
+    struct alignas(CACHE_LINE_SIZE) Queue
+    {
+        std::mutex mutex;
+        std::array<Job, QUEUE_CAPACITY> jobs{};
+        std::size_t head{};
+        std::size_t tail{};
+
+        bool Push(Job const& job)
+        {
+            std::lock_guard lock(mutex);
+
+            if (tail - head == QUEUE_CAPACITY)
+            {
+                return false;
+            }
+
+            jobs[tail++ % QUEUE_CAPACITY] = job;
+            return true;
+        }
+
+        bool PopBack(Job& job)
+        {
+            std::lock_guard lock(mutex);
+
+            if (tail == head)
+            {
+                return false;
+            }
+
+            job = jobs[--tail % QUEUE_CAPACITY];
+            return true;
+        }
+
+        bool StealFront(Job& job)
+        {
+            std::lock_guard lock(mutex);
+
+            if (tail == head)
+            {
+                return false;
+            }
+
+            job = jobs[head++ % QUEUE_CAPACITY];
+            return true;
+        }
+    };
+
+    std::vector<std::unique_ptr<Queue>> mQueues{};
+    std::vector<std::thread> mThreads{};
+
+    std::mutex mSleepMutex;
+    std::condition_variable mWake;
+    std::atomic<std::size_t> mPending{0};
+    bool mStop = false;
+
+    // Which pool (if any) the current thread works for, and its queue in that pool
+    static inline thread_local JobSystem const* sOwner = nullptr;
+    static inline thread_local std::size_t sQueueIndex = 0;
+
+
+    std::size_t CurrentQueue() const
+    {
+        return sOwner == this ? sQueueIndex : 0;
+    }
+
+    bool TryTake(std::size_t self, Job& job)
+    {
+        bool found = mQueues[self]->PopBack(job);
+
+        for (std::size_t i = 1; !found && i < mQueues.size(); ++i)
+        {
+            found = mQueues[(self + i) % mQueues.size()]->StealFront(job);
+        }
+
+        if (found)
+        {
+            mPending.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        return found;
+    }
+
+    static void Execute(Job const& job)
+    {
+        job.function(job.context, job.index);
+
+        if (job.counter)
+        {
+            job.counter->remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void WorkerLoop(std::size_t queueIndex)
+    {
+        sOwner = this;
+        sQueueIndex = queueIndex;
+
+        while (true)
+        {
+            if (RunPending())
+            {
+                continue;
+            }
+
+            std::unique_lock lock(mSleepMutex);
+            mWake.wait(lock, [this] { return mStop || mPending.load(std::memory_order_acquire) != 0; });
+
+            if (mStop)
+            {
+                return;
+            }
+        }
+    }
+};
@@ -1,22 +1,56 @@
 #pragma once
 
+#include "ArchetypeManager.h"
+#include "ChangeTracker.h"
+#include "CommandBuffer.h"
 #include "ComponentManager.h"
 #include "EntityManager.h"
 #include "EventManager.h"
+#include "JobSystem.h"
 #include "SystemManager.h"
+#include "SystemScheduler.h"
+#include "TypeIndex.h"
 #include "Types.h"
+#include "View.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 
 class Mediator
 {
 public:
-	void Init()
+	void Init(EntityIndex maxEntities = MAX_ENTITIES, ComponentStorage storage = ComponentStorage::Sparse)
 	{
+		mStorage = storage;
 		mComponentManager = std::make_unique<ComponentManager>();
-		mEntityManager = std::make_unique<EntityManager>();
+		mArchetypeManager = std::make_unique<ArchetypeManager>();
+		mEntityManager = std::make_unique<EntityManager>(maxEntities);
 		mEventManager = std::make_unique<EventManager>();
 		mSystemManager = std::make_unique<SystemManager>();
+		mJobSystem = std::make_unique<JobSystem>();
+		mSystemScheduler = std::make_unique<SystemScheduler>(*mJobSystem);
+
+		for (auto& tracker : mChangeTrackers)
+		{
+			tracker.reset();
+		}
+
+		for (auto& resource : mResources)
+		{
+			resource.reset();
+		}
+
+		// Invalidates every thread's cached command buffer from a previous Init
+		mCommandBuffers.clear();
+		mCommandBufferGeneration = sNextCommandBufferGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
 	}
 
 
@@ -26,13 +60,75 @@ public:
 		return mEntityManager->CreateEntity();
 	}
 
+	// Appends count new entities to out
+	void CreateEntities(std::size_t count, std::vector<Entity>& out)
+	{
+		mEntityManager->CreateEntities(count, out);
+	}
+
+	EntityIndex GetMaxEntities() const
+	{
+		return mEntityManager->GetMaxEntities();
+	}
+
+	// False once the entity has been destroyed, even if its slot was reused since
+	bool IsAlive(Entity entity) const
+	{
+		return mEntityManager->IsAlive(entity);
+	}
+
+	// Only the storage and systems the entity's signature names are touched
 	void DestroyEntity(Entity entity)
 	{
+		auto signature = mEntityManager->GetSignature(entity);
+
+		if (mStorage == ComponentStorage::Archetype)
+		{
+			mArchetypeManager->EntityDestroyed(entity);
+		}
+		else
+		{
+			mComponentManager->EntityDestroyed(entity, signature);
+		}
+
+		mSystemManager->EntityDestroyed(entity, signature);
 		mEntityManager->DestroyEntity(entity);
+	}
+
+	// Destroys every entity in entities (each listed once), visiting each pool and system a single time.
+	// memberSignatures, if given, holds per entity the signature systems last matched it against,
+	// when that differs from its current one (see Playback).
+	void DestroyEntities(std::span<Entity const> entities, std::span<Signature const> memberSignatures = {})
+	{
+		assert((memberSignatures.empty() || memberSignatures.size() == entities.size()) && "One member signature per destroyed entity.");
+
+		Signature used;
+
+		mSignatures.clear();
+		for (Entity entity : entities)
+		{
+			mSignatures.push_back(mEntityManager->GetSignature(entity));
+			used |= mSignatures.back();
+		}
 
-		mComponentManager->EntityDestroyed(entity);
+		if (mStorage == ComponentStorage::Archetype)
+		{
+			for (Entity entity : entities)
+			{
+				mArchetypeManager->EntityDestroyed(entity);
+			}
+		}
+		else
+		{
+			mComponentManager->EntitiesDestroyed(entities, used);
+		}
 
-		mSystemManager->EntityDestroyed(entity);
+		mSystemManager->EntitiesDestroyed(entities, memberSignatures.empty() ? std::span<Signature const>(mSignatures) : memberSignatures);
+
+		for (Entity entity : entities)
+		{
+			mEntityManager->DestroyEntity(entity);
+		}
 	}
 
 
@@ -41,36 +137,133 @@ public:
 	void RegisterComponent()
 	{
 		mComponentManager->RegisterComponent<T>();
+		mArchetypeManager->RegisterComponent<T>(mComponentManager->GetComponentType<T>());
 	}
 
 	template<typename T>
 	void AddComponent(Entity entity, T component)
 	{
-		mComponentManager->AddComponent<T>(entity, component);
+		auto signature = AddComponentData<T>(entity, std::move(component));
+		auto previous = signature;
+		previous.reset(GetComponentType<T>());
 
-		auto signature = mEntityManager->GetSignature(entity);
-		signature.set(mComponentManager->GetComponentType<T>(), true);
-		mEntityManager->SetSignature(entity, signature);
+		mSystemManager->EntitySignatureChanged(entity, previous, signature);
+	}
+
+	// Adds one of each Ts to every entity: components[i] goes to entities[i] and is moved from. Storage
+	// is reserved up front and system membership is updated in a single pass at the end.
+	template<typename... Ts>
+	void AddComponents(std::span<Entity const> entities, std::type_identity_t<std::span<Ts>>... components)
+	{
+		assert(((components.size() == entities.size()) && ...) && "Component count does not match entity count.");
+
+		if (mStorage == ComponentStorage::Archetype)
+		{
+			mArchetypeManager->AddComponents<Ts...>(entities, {GetComponentType<Ts>()...}, components...);
+		}
+		else
+		{
+			(mComponentManager->AddComponents<Ts>(entities, components), ...);
+		}
+
+		Signature added;
+		(added.set(GetComponentType<Ts>(), true), ...);
+
+		mSignatures.clear();
+		for (Entity entity : entities)
+		{
+			auto signature = mEntityManager->GetSignature(entity) | added;
+			mEntityManager->SetSignature(entity, signature);
+			mSignatures.push_back(signature);
+		}
 
-		mSystemManager->EntitySignatureChanged(entity, signature);
+		mSystemManager->EntitiesSignatureChanged(entities, mSignatures, added);
+
+		(MarkChanged(GetComponentType<Ts>(), entities), ...);
 	}
 
 	template<typename T>
 	void RemoveComponent(Entity entity)
 	{
-		mComponentManager->RemoveComponent<T>(entity);
+		auto signature = RemoveComponentData<T>(entity);
+		auto previous = signature;
+		previous.set(GetComponentType<T>());
 
-		auto signature = mEntityManager->GetSignature(entity);
-		signature.set(mComponentManager->GetComponentType<T>(), false);
-		mEntityManager->SetSignature(entity, signature);
-
-		mSystemManager->EntitySignatureChanged(entity, signature);
+		mSystemManager->EntitySignatureChanged(entity, previous, signature);
 	}
 
+	// GetComponent<T const> reads without counting as a change
 	template<typename T>
 	T& GetComponent(Entity entity)
 	{
-		return mComponentManager->GetComponent<T>(entity);
+		using Component = std::remove_const_t<T>;
+
+		if constexpr (!std::is_const_v<T>)
+		{
+			MarkChanged(GetComponentType<Component>(), entity);
+		}
+
+		if (mStorage == ComponentStorage::Archetype)
+		{
+			return mArchetypeManager->GetComponent<Component>(entity, GetComponentType<Component>());
+		}
+
+		return mComponentManager->GetComponent<Component>(entity);
+	}
+
+	template<typename T>
+	bool HasComponent(Entity entity)
+	{
+		return mEntityManager->GetSignature(entity).test(GetComponentType<T>());
+	}
+
+	// Resolves the storage of every T once; iterate with view.Each(fn(Entity, Ts&...)) or fn(Ts&...)
+	template<typename... Ts>
+	::View<Ts...> View()
+	{
+		std::array<ChangeTracker*, sizeof...(Ts)> trackers{
+			(std::is_const_v<Ts> ? nullptr : mChangeTrackers[GetComponentType<std::remove_const_t<Ts>>()].get())...
+		};
+
+		if (mStorage == ComponentStorage::Archetype)
+		{
+			return ::View<Ts...>(mArchetypeManager.get(), {GetComponentType<std::remove_const_t<Ts>>()...}, trackers);
+		}
+
+		return ::View<Ts...>(trackers, mComponentManager->GetComponentArray<std::remove_const_t<Ts>>()...);
+	}
+
+	template<typename... Ts, typename Fn>
+	void Each(Fn&& fn)
+	{
+		View<Ts...>().Each(std::forward<Fn>(fn));
+	}
+
+	// Each, chunked across the job system; see View::ParallelEach for the guarantees
+	template<typename... Ts, typename Fn>
+	void ParallelEach(Fn&& fn, std::size_t grainSize = 0)
+	{
+		View<Ts...>().ParallelEach(*mJobSystem, std::forward<Fn>(fn), grainSize);
+	}
+
+	// Packs T's storage in the order the system visits its entities, so a loop over mEntities reads
+	// T sequentially. Archetype tables are already packed per signature, so this is a no-op there.
+	template<typename T>
+	void SortComponents(System const& system)
+	{
+		if (mStorage == ComponentStorage::Sparse)
+		{
+			mComponentManager->SortAs<T>(system.mEntities);
+		}
+	}
+
+	// Archetype storage only: calls fn(archetype) for every table holding all components in signature
+	template<typename Fn>
+	void ForEachArchetype(Signature signature, Fn&& fn)
+	{
+		assert(mStorage == ComponentStorage::Archetype && "Archetype iteration requires archetype storage.");
+
+		mArchetypeManager->ForEachArchetype(signature, std::forward<Fn>(fn));
 	}
 
 	template<typename T>
@@ -80,6 +273,82 @@ public:
 	}
 
 
+	// Change detection methods
+
+	// Stamps T with a change version on every write or removal from now on; entities that already have a T
+	// count as changed. Call after RegisterComponent<T>.
+	template<typename T>
+	void TrackChanges()
+	{
+		ComponentType type = GetComponentType<T>();
+
+		assert(!mChangeTrackers[type] && "Tracking changes of a component type twice.");
+
+		mChangeTrackers[type] = std::make_unique<ChangeTracker>(mChangeClock, GetMaxEntities());
+	}
+
+	template<typename T>
+	ChangeTracker const& GetChangeTracker()
+	{
+		ComponentType type = GetComponentType<T>();
+
+		assert(mChangeTrackers[type] && "Component type does not track changes.");
+
+		return *mChangeTrackers[type];
+	}
+
+	// Closes a reader's window: returns the version to pass to ChangedSince on its next pass. Every
+	// write made after this call compares greater. Readers start from version 0.
+	ChangeVersion AdvanceChangeVersion()
+	{
+		return mChangeClock.fetch_add(1, std::memory_order_relaxed);
+	}
+
+
+	// Resource methods
+
+	// A single T owned by the mediator, for shared state that belongs to no entity (a spatial index,
+	// say). Systems that use one declare it with SystemAccess::WithResources.
+	template<typename T, typename... Args>
+	T& AddResource(Args&&... args)
+	{
+		std::size_t type = GetResourceType<T>();
+
+		assert(!mResources[type] && "Adding a resource more than once.");
+
+		auto resource = std::make_shared<T>(std::forward<Args>(args)...);
+		mResources[type] = resource;
+
+		return *resource;
+	}
+
+	template<typename T>
+	T& GetResource()
+	{
+		std::size_t type = GetResourceType<T>();
+
+		assert(mResources[type] && "Resource not added.");
+
+		return *static_cast<T*>(mResources[type].get());
+	}
+
+	template<typename T>
+	bool HasResource()
+	{
+		return mResources[GetResourceType<T>()] != nullptr;
+	}
+
+	template<typename T>
+	std::size_t GetResourceType()
+	{
+		std::size_t type = TypeIndex<ResourceFamily>::Get<T>();
+
+		assert(type < MAX_COMPONENTS && "Too many resource types.");
+
+		return type;
+	}
+
+
 	// System methods
 	template<typename T>
 	std::shared_ptr<T> RegisterSystem()
@@ -93,21 +362,137 @@ public:
 		mSystemManager->SetSignature<T>(signature);
 	}
 
+	template<typename T>
+	void SetSystemAccess(SystemAccess const& access)
+	{
+		mSystemManager->SetAccess<T>(access);
+	}
+
+	// Runs every registered system once, in parallel where their declared access allows
+	void UpdateSystems(float deltaTime)
+	{
+		if (mSystemScheduler->IsStale(*mSystemManager))
+		{
+			mSystemScheduler->Build(*mSystemManager);
+		}
+
+		mSystemScheduler->Run(deltaTime);
+
+		FlushCommandBuffers();
+	}
+
+	JobSystem& GetJobSystem() { return *mJobSystem; }
+
+
+	// Command buffer methods
+
+	// The calling thread's buffer; structural changes recorded into it are applied at the next flush
+	CommandBuffer& GetCommandBuffer()
+	{
+		thread_local Mediator* owner = nullptr;
+		thread_local std::size_t generation = 0;
+		thread_local CommandBuffer* buffer = nullptr;
+
+		if (owner != this || generation != mCommandBufferGeneration)
+		{
+			std::lock_guard lock(mCommandBufferMutex);
+
+			mCommandBuffers.push_back(std::make_unique<CommandBuffer>());
+			owner = this;
+			generation = mCommandBufferGeneration;
+			buffer = mCommandBuffers.back().get();
+		}
+
+		return *buffer;
+	}
+
+	// Plays back every thread's command buffer. Runs at the end of UpdateSystems; call it directly
+	// only while no system is running.
+	void FlushCommandBuffers()
+	{
+		std::lock_guard lock(mCommandBufferMutex);
+
+		for (auto& buffer : mCommandBuffers)
+		{
+			if (!buffer->Empty())
+			{
+				Playback(*buffer);
+			}
+		}
+	}
+
 
 	// Event methods
-	void AddEventListener(EventId eventId, std::function<void(Event&)> const& listener)
+
+	// AddEventListener<Event, &Class::Method>(object)
+	template<typename E, auto Method, typename C>
+	ListenerHandle AddEventListener(C* object)
+	{
+		return mEventManager->AddListener<E>(Delegate<void(E const&)>::template Bind<Method>(object));
+	}
+
+	// AddEventListener<Event, &Function>()
+	template<typename E, auto Function>
+	ListenerHandle AddEventListener()
+	{
+		return mEventManager->AddListener<E>(Delegate<void(E const&)>::template Bind<Function>());
+	}
+
+	// A small trivially copyable callable, such as a lambda capturing a pointer
+	template<typename E, typename F>
+	ListenerHandle AddEventListener(F&& listener)
 	{
-		mEventManager->AddListener(eventId, listener);
+		return mEventManager->AddListener<E>(Delegate<void(E const&)>::Bind(std::forward<F>(listener)));
 	}
 
-	void SendEvent(Event& event)
+	// fn(std::span<E const>): every event of the frame at once when E is queued, one at a time otherwise
+	template<typename E, auto Method, typename C>
+	ListenerHandle AddEventBatchListener(C* object)
+	{
+		return mEventManager->AddBatchListener<E>(Delegate<void(std::span<E const>)>::template Bind<Method>(object));
+	}
+
+	template<typename E, typename F>
+	ListenerHandle AddEventBatchListener(F&& listener)
+	{
+		return mEventManager->AddBatchListener<E>(Delegate<void(std::span<E const>)>::Bind(std::forward<F>(listener)));
+	}
+
+	void RemoveEventListener(ListenerHandle const& handle)
+	{
+		mEventManager->RemoveListener(handle);
+	}
+
+	template<typename E>
+	void SendEvent(E const& event)
 	{
 		mEventManager->SendEvent(event);
 	}
 
-	void SendEvent(EventId eventId)
+	// Queued event types are buffered by SendEvent and delivered by DispatchEvents
+	template<typename E>
+	void SetEventQueued(bool queued = true)
+	{
+		mEventManager->SetQueued<E>(queued);
+	}
+
+	// Allows PostEvent<E> from any thread (systems running on workers); see EventManager
+	template<typename E>
+	void EnableEventPosting(std::size_t capacity = 1024)
+	{
+		mEventManager->EnablePosting<E>(capacity);
+	}
+
+	// Thread safe; delivered at the next DispatchEvents. False if the event was dropped.
+	template<typename E>
+	bool PostEvent(E const& event)
+	{
+		return mEventManager->PostEvent(event);
+	}
+
+	void DispatchEvents()
 	{
-		mEventManager->SendEvent(eventId);
+		mEventManager->DispatchEvents();
 	}
 
 
@@ -116,10 +501,193 @@ public:
 
 
 private:
+	template<typename T>
+	friend class CommandList;
+
 	std::unique_ptr<ComponentManager> mComponentManager;
+	std::unique_ptr<ArchetypeManager> mArchetypeManager;
 	std::unique_ptr<EntityManager> mEntityManager;
 	std::unique_ptr<EventManager> mEventManager;
 	std::unique_ptr<SystemManager> mSystemManager;
+	std::unique_ptr<JobSystem> mJobSystem;
+	std::unique_ptr<SystemScheduler> mSystemScheduler;
+
+	ComponentStorage mStorage = ComponentStorage::Sparse;
+
+	Entity mMainCamera = NULL_ENTITY;
+
+	std::atomic<ChangeVersion> mChangeClock{1};
+	std::array<std::unique_ptr<ChangeTracker>, MAX_COMPONENTS> mChangeTrackers{};
+
+	// Type-erased; the shared_ptr keeps each resource's deleter
+	std::array<std::shared_ptr<void>, MAX_COMPONENTS> mResources{};
 
-	Entity mMainCamera = 0;
+	std::mutex mCommandBufferMutex;
+	std::vector<std::unique_ptr<CommandBuffer>> mCommandBuffers{};
+	std::size_t mCommandBufferGeneration{};
+	static inline std::atomic<std::size_t> sNextCommandBufferGeneration{0};
+
+	// Scratch kept between calls to avoid reallocating
+	std::vector<Signature> mSignatures{};
+	std::vector<Entity> mCreatedEntities{};
+	TouchedEntities mTouchedEntities{};
+	SparseSet mDestroyedEntities{};
+	std::vector<Signature> mDestroyedSignatures{};
+
+
+	void MarkChanged(ComponentType type, Entity entity)
+	{
+		if (mChangeTrackers[type])
+		{
+			mChangeTrackers[type]->MarkChanged(entity);
+		}
+	}
+
+	void MarkChanged(ComponentType type, std::span<Entity const> entities)
+	{
+		if (mChangeTrackers[type])
+		{
+			for (Entity entity : entities)
+			{
+				mChangeTrackers[type]->MarkChanged(entity);
+			}
+		}
+	}
+
+	// Storage and entity signature only; system membership is up to the caller
+	template<typename T>
+	Signature AddComponentData(Entity entity, T component)
+	{
+		if (mStorage == ComponentStorage::Archetype)
+		{
+			mArchetypeManager->AddComponent<T>(entity, GetComponentType<T>(), std::move(component));
+		}
+		else
+		{
+			mComponentManager->AddComponent<T>(entity, std::move(component));
+		}
+
+		MarkChanged(GetComponentType<T>(), entity);
+
+		auto signature = mEntityManager->GetSignature(entity);
+		signature.set(mComponentManager->GetComponentType<T>(), true);
+		mEntityManager->SetSignature(entity, signature);
+
+		return signature;
+	}
+
+	template<typename T>
+	Signature RemoveComponentData(Entity entity)
+	{
+		if (mStorage == ComponentStorage::Archetype)
+		{
+			mArchetypeManager->RemoveComponent(entity, GetComponentType<T>());
+		}
+		else
+		{
+			mComponentManager->RemoveComponent<T>(entity);
+		}
+
+		// Removal counts as a change, so readers that key off T notice the entity dropping out
+		MarkChanged(GetComponentType<T>(), entity);
+
+		auto signature = mEntityManager->GetSignature(entity);
+		signature.set(mComponentManager->GetComponentType<T>(), false);
+		mEntityManager->SetSignature(entity, signature);
+
+		return signature;
+	}
+
+	void Playback(CommandBuffer& buffer)
+	{
+		mCreatedEntities.clear();
+		CreateEntities(buffer.mCreateCount, mCreatedEntities);
+
+		// One batch per component type, in type order
+		std::sort(buffer.mUsedLists.begin(), buffer.mUsedLists.end());
+		for (std::size_t index : buffer.mUsedLists)
+		{
+			buffer.mLists[index]->Playback(*this, mCreatedEntities, mTouchedEntities);
+		}
+
+		// An entity may be destroyed by several buffers (or twice in one); only the first counts.
+		// Systems have not yet seen a touched entity's new signature, so it leaves them by the old one.
+		mDestroyedEntities.Clear();
+		mDestroyedSignatures.clear();
+		for (Entity entity : buffer.mDestroyed)
+		{
+			if (!IsAlive(entity) || mDestroyedEntities.Contains(entity))
+			{
+				continue;
+			}
+
+			Signature members = mEntityManager->GetSignature(entity);
+			if (mTouchedEntities.Contains(entity))
+			{
+				members = mTouchedEntities.Remove(entity);
+			}
+
+			mDestroyedEntities.Insert(entity);
+			mDestroyedSignatures.push_back(members);
+		}
+
+		DestroyEntities({mDestroyedEntities.Data(), mDestroyedEntities.Size()}, mDestroyedSignatures);
+
+		// Systems see every entity once, with its final signature
+		for (std::size_t i = 0; i < mTouchedEntities.Size(); ++i)
+		{
+			Entity entity = mTouchedEntities.At(i);
+			mSystemManager->EntitySignatureChanged(entity, mTouchedEntities.Previous(i), mEntityManager->GetSignature(entity));
+		}
+
+		mTouchedEntities.Clear();
+		buffer.mCreateCount = 0;
+		buffer.mDestroyed.clear();
+		buffer.mUsedLists.clear();
+	}
 };
+
+
+template<typename T>
+void CommandList<T>::Playback(Mediator& mediator, std::vector<Entity> const& created, TouchedEntities& touched)
+{
+	for (auto& command : mCommands)
+	{
+		if (command.target.pending)
+		{
+			command.target = CommandTarget{created[command.target.entity], false};
+		}
+	}
+
+	// Entity order keeps the storage writes sequential; stable so an entity's commands keep their order
+	std::stable_sort(mCommands.begin(), mCommands.end(), [](Command const& lhs, Command const& rhs) {
+		return GetEntityIndex(lhs.target.entity) < GetEntityIndex(rhs.target.entity);
+	});
+
+	for (auto& command : mCommands)
+	{
+		Entity entity = command.target.entity;
+
+		// Destroyed by an earlier buffer in this flush
+		if (!mediator.IsAlive(entity))
+		{
+			continue;
+		}
+
+		if (!touched.Contains(entity))
+		{
+			touched.Insert(entity, mediator.mEntityManager->GetSignature(entity));
+		}
+
+		if (command.component)
+		{
+			mediator.AddComponentData<T>(entity, std::move(*command.component));
+		}
+		else
+		{
+			mediator.RemoveComponentData<T>(entity);
+		}
+	}
+
+	mCommands.clear();
+}
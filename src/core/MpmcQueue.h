@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Types.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+
+// Bounded lock-free multi-producer multi-consumer queue (Dmitry Vyukov's design). Every cell carries
+// a sequence number that says whose turn it is: producers and consumers each claim a position with
+// one CAS on their own counter and then hand the cell over by publishing its next sequence, so
+// neither side ever waits on a lock. The two counters sit on separate cache lines.
+template<typename T>
+class MpmcQueue
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpmcQueue(std::size_t capacity)
+        : mCells(std::make_unique<Cell[]>(std::bit_ceil(std::max<std::size_t>(capacity, 2)))),
+          mMask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+    {
+        for (std::size_t i = 0; i <= mMask; ++i)
+        {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(MpmcQueue const&) = delete;
+    MpmcQueue& operator=(MpmcQueue const&) = delete;
+
+    std::size_t Capacity() const { return mMask + 1; }
+
+    // Returns false instead of blocking when the queue is full
+    bool TryPush(T const& value)
+    {
+        std::size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Cell& cell = mCells[position & mMask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (difference == 0)
+            {
+                if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = mEnqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(T& value)
+    {
+        return Drain([&](T& element) { value = std::move(element); }, 1) == 1;
+    }
+
+    // Pops up to maxCount elements, calling fn(T&) on each in queue order, and returns how many it
+    // took. A run of ready cells is claimed with a single CAS, so draining a backlog costs one atomic
+    // read-modify-write per batch rather than per element.
+    template<typename Fn>
+    std::size_t Drain(Fn&& fn, std::size_t maxCount = ~std::size_t{0})
+    {
+        std::size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+        std::size_t count;
+
+        while (true)
+        {
+            // Count the consecutive cells producers have finished writing
+            count = 0;
+            while (count < maxCount && count <= mMask
+                && mCells[(position + count) & mMask].sequence.load(std::memory_order_acquire) == position + count + 1)
+            {
+                ++count;
+            }
+
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            if (mDequeuePosition.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Cell& cell = mCells[(position + i) & mMask];
+
+            fn(cell.value);
+            cell.sequence.store(position + i + mMask + 1, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence{};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> mCells;
+    std::size_t const mMask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mEnqueuePosition{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mDequeuePosition{0};
+};
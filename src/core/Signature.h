@@ -0,0 +1,212 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+
+// Fixed-width component mask stored as 64-bit words. It keeps the subset of the std::bitset
+// interface the ECS uses (set, reset, test, any, none, count and the bitwise operators), and adds
+// the operations the hot paths need: a subset test that touches 128 or 256 bits per instruction
+// where SSE/AVX2 is available, a word-at-a-time hash, and iteration over set bits only.
+template<std::size_t BITS>
+class BasicSignature
+{
+public:
+    static constexpr std::size_t WORD_BITS = 64;
+    static constexpr std::size_t WORD_COUNT = (BITS + WORD_BITS - 1) / WORD_BITS;
+
+    static_assert(BITS > 0, "A signature needs at least one bit.");
+
+    constexpr std::size_t size() const { return BITS; }
+
+    constexpr BasicSignature& set(std::size_t bit, bool value = true)
+    {
+        assert(bit < BITS && "Signature bit out of range.");
+
+        std::uint64_t const mask = std::uint64_t{1} << (bit % WORD_BITS);
+        mWords[bit / WORD_BITS] = value ? mWords[bit / WORD_BITS] | mask : mWords[bit / WORD_BITS] & ~mask;
+        return *this;
+    }
+
+    constexpr BasicSignature& reset(std::size_t bit)
+    {
+        return set(bit, false);
+    }
+
+    constexpr BasicSignature& reset()
+    {
+        mWords.fill(0);
+        return *this;
+    }
+
+    constexpr bool test(std::size_t bit) const
+    {
+        assert(bit < BITS && "Signature bit out of range.");
+
+        return (mWords[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1;
+    }
+
+    constexpr bool any() const
+    {
+        std::uint64_t bits = 0;
+        for (std::uint64_t word : mWords)
+        {
+            bits |= word;
+        }
+
+        return bits != 0;
+    }
+
+    constexpr bool none() const { return !any(); }
+
+    constexpr std::size_t count() const
+    {
+        std::size_t total = 0;
+        for (std::uint64_t word : mWords)
+        {
+            total += static_cast<std::size_t>(std::popcount(word));
+        }
+
+        return total;
+    }
+
+    // (*this & required) == required, without building the intermediate mask
+    bool Includes(BasicSignature const& required) const
+    {
+        std::size_t word = 0;
+
+#if defined(__AVX2__)
+        for (; word + 4 <= WORD_COUNT; word += 4)
+        {
+            __m256i have = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&mWords[word]));
+            __m256i need = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&required.mWords[word]));
+
+            // Carry flag: (~have & need) == 0
+            if (!_mm256_testc_si256(have, need))
+            {
+                return false;
+            }
+        }
+#endif
+
+#if defined(__SSE4_1__)
+        for (; word + 2 <= WORD_COUNT; word += 2)
+        {
+            __m128i have = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&mWords[word]));
+            __m128i need = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&required.mWords[word]));
+
+            if (!_mm_testc_si128(have, need))
+            {
+                return false;
+            }
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; word + 2 <= WORD_COUNT; word += 2)
+        {
+            __m128i have = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&mWords[word]));
+            __m128i need = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&required.mWords[word]));
+            __m128i missing = _mm_andnot_si128(have, need);
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) != 0xFFFF)
+            {
+                return false;
+            }
+        }
+#endif
+
+        for (; word < WORD_COUNT; ++word)
+        {
+            if (required.mWords[word] & ~mWords[word])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Calls fn(bit) for every set bit, lowest first; cost follows the number of set bits, not BITS
+    template<typename Fn>
+    void ForEachSetBit(Fn&& fn) const
+    {
+        for (std::size_t word = 0; word < WORD_COUNT; ++word)
+        {
+            for (std::uint64_t bits = mWords[word]; bits != 0; bits &= bits - 1)
+            {
+                fn(word * WORD_BITS + static_cast<std::size_t>(std::countr_zero(bits)));
+            }
+        }
+    }
+
+    std::size_t Hash() const
+    {
+        // Multiply-xorshift per word; one word per step regardless of width
+        std::uint64_t hash = 0x9E3779B97F4A7C15ull;
+        for (std::uint64_t word : mWords)
+        {
+            hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 32;
+        }
+
+        return static_cast<std::size_t>(hash);
+    }
+
+    constexpr BasicSignature& operator&=(BasicSignature const& other)
+    {
+        for (std::size_t word = 0; word < WORD_COUNT; ++word)
+        {
+            mWords[word] &= other.mWords[word];
+        }
+        return *this;
+    }
+
+    constexpr BasicSignature& operator|=(BasicSignature const& other)
+    {
+        for (std::size_t word = 0; word < WORD_COUNT; ++word)
+        {
+            mWords[word] |= other.mWords[word];
+        }
+        return *this;
+    }
+
+    constexpr BasicSignature& operator^=(BasicSignature const& other)
+    {
+        for (std::size_t word = 0; word < WORD_COUNT; ++word)
+        {
+            mWords[word] ^= other.mWords[word];
+        }
+        return *this;
+    }
+
+    friend constexpr BasicSignature operator&(BasicSignature lhs, BasicSignature const& rhs) { return lhs &= rhs; }
+    friend constexpr BasicSignature operator|(BasicSignature lhs, BasicSignature const& rhs) { return lhs |= rhs; }
+    friend constexpr BasicSignature operator^(BasicSignature lhs, BasicSignature const& rhs) { return lhs ^= rhs; }
+
+    friend constexpr bool operator==(BasicSignature const& lhs, BasicSignature const& rhs) = default;
+
+private:
+    // Bits past BITS in the last word are always zero
+    std::array<std::uint64_t, WORD_COUNT> mWords{};
+};
+
+
+template<std::size_t BITS>
+struct std::hash<BasicSignature<BITS>>
+{
+    std::size_t operator()(BasicSignature<BITS> const& signature) const noexcept
+    {
+        return signature.Hash();
+    }
+};
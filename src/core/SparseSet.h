@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Types.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+// Entity -> packed index map made of a paged sparse array and a dense entity vector.
+// Sparse pages are allocated the first time an entity in their range is inserted, so memory follows
+// the highest entity index in use rather than a compile-time maximum. The sparse side is keyed by the
+// entity's index; the dense side keeps whole handles, so a stale version is never Contained.
+class SparseSet
+{
+public:
+    static constexpr std::size_t PAGE_SIZE = 4096;
+    static constexpr std::uint32_t TOMBSTONE = std::numeric_limits<std::uint32_t>::max();
+
+    static_assert((PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "Sparse page size must be a power of two.");
+
+    // Returns the dense index the entity was placed at (always the back)
+    std::size_t Insert(Entity entity)
+    {
+        assert(!Contains(entity) && "Entity inserted into sparse set more than once.");
+
+        auto const index = mDense.size();
+        AssurePage(entity)[Offset(entity)] = static_cast<std::uint32_t>(index);
+        mDense.push_back(entity);
+
+        return index;
+    }
+
+    // Swap-and-pop: the last entity takes the removed entity's dense slot, whose index is returned.
+    // Owners of parallel dense arrays must move their last element into that slot as well.
+    std::size_t Remove(Entity entity)
+    {
+        assert(Contains(entity) && "Removing entity not in sparse set.");
+
+        auto const index = IndexOf(entity);
+        Entity const last = mDense.back();
+
+        mDense[index] = last;
+        mSparse[Page(last)][Offset(last)] = static_cast<std::uint32_t>(index);
+        mSparse[Page(entity)][Offset(entity)] = TOMBSTONE;
+        mDense.pop_back();
+
+        return index;
+    }
+
+    // Exchanges the dense slots at two indices, keeping the sparse side consistent
+    void Swap(std::size_t lhs, std::size_t rhs)
+    {
+        assert(lhs < mDense.size() && rhs < mDense.size() && "Dense index out of range.");
+
+        std::swap(mDense[lhs], mDense[rhs]);
+        mSparse[Page(mDense[lhs])][Offset(mDense[lhs])] = static_cast<std::uint32_t>(lhs);
+        mSparse[Page(mDense[rhs])][Offset(mDense[rhs])] = static_cast<std::uint32_t>(rhs);
+    }
+
+    bool Contains(Entity entity) const
+    {
+        auto const page = Page(entity);
+
+        if (page >= mSparse.size() || !mSparse[page])
+        {
+            return false;
+        }
+
+        auto const index = mSparse[page][Offset(entity)];
+        return index != TOMBSTONE && mDense[index] == entity;
+    }
+
+    // No bounds checks beyond the assert: callers are expected to know the entity is present
+    std::size_t IndexOf(Entity entity) const
+    {
+        assert(Contains(entity) && "Entity not in sparse set.");
+
+        return mSparse[Page(entity)][Offset(entity)];
+    }
+
+    Entity At(std::size_t index) const
+    {
+        assert(index < mDense.size() && "Dense index out of range.");
+
+        return mDense[index];
+    }
+
+    void Reserve(std::size_t capacity)
+    {
+        mDense.reserve(capacity);
+    }
+
+    void Clear()
+    {
+        for (Entity entity : mDense)
+        {
+            mSparse[Page(entity)][Offset(entity)] = TOMBSTONE;
+        }
+
+        mDense.clear();
+    }
+
+    std::size_t Size() const { return mDense.size(); }
+    bool Empty() const { return mDense.empty(); }
+    Entity const* Data() const { return mDense.data(); }
+
+    auto begin() const { return mDense.begin(); }
+    auto end() const { return mDense.end(); }
+
+private:
+    std::vector<std::unique_ptr<std::uint32_t[]>> mSparse{};
+    std::vector<Entity> mDense{};
+
+
+    static std::size_t Page(Entity entity)
+    {
+        return GetEntityIndex(entity) / PAGE_SIZE;
+    }
+
+    static std::size_t Offset(Entity entity)
+    {
+        return GetEntityIndex(entity) & (PAGE_SIZE - 1);
+    }
+
+    std::uint32_t* AssurePage(Entity entity)
+    {
+        auto const page = Page(entity);
+
+        if (page >= mSparse.size())
+        {
+            mSparse.resize(page + 1);
+        }
+
+        if (!mSparse[page])
+        {
+            mSparse[page] = std::make_unique<std::uint32_t[]>(PAGE_SIZE);
+            std::fill_n(mSparse[page].get(), PAGE_SIZE, TOMBSTONE);
+        }
+
+        return mSparse[page].get();
+    }
+};
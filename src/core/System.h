@@ -1,7 +1,52 @@
 #pragma once
 
+#include "SparseSet.h"
 #include "Types.h"
-#include <set>
+
+
+enum class ThreadAffinity
+{
+    Any,
+    MainThread  // Touches the GL context or other main-thread-only state
+};
+
+
+// What a system touches, for the scheduler. Systems that never declare access are treated as
+// reading and writing everything, so they never run alongside anything else.
+struct SystemAccess
+{
+    Signature reads{};
+    Signature writes{};
+    ThreadAffinity affinity = ThreadAffinity::Any;
+    bool exclusive = true;
+
+    // Bits are Mediator::GetResourceType indices
+    Signature resourceReads{};
+    Signature resourceWrites{};
+
+    static SystemAccess Declare(Signature reads, Signature writes, ThreadAffinity affinity = ThreadAffinity::Any)
+    {
+        return SystemAccess{reads, writes, affinity, false};
+    }
+
+    // Declare(...).WithResources(reads, writes) for systems that also use Mediator resources
+    SystemAccess WithResources(Signature reads, Signature writes) const
+    {
+        SystemAccess access = *this;
+        access.resourceReads = reads;
+        access.resourceWrites = writes;
+        return access;
+    }
+
+    bool ConflictsWith(SystemAccess const& other) const
+    {
+        return exclusive || other.exclusive
+            || (writes & (other.reads | other.writes)).any()
+            || (other.writes & reads).any()
+            || (resourceWrites & (other.resourceReads | other.resourceWrites)).any()
+            || (other.resourceWrites & resourceReads).any();
+    }
+};
 
 
 class System
@@ -12,5 +57,6 @@ public:
     virtual void Init() = 0;
     virtual void Update(float deltaTime) = 0;
 
-    std::set<Entity> mEntities;
+    // Packed membership list: O(1) insert/erase, iteration walks a contiguous array
+    SparseSet mEntities;
 };
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "System.h"
+#include "TypeIndex.h"
 #include "Types.h"
+#include <array>
 #include <cassert>
+#include <limits>
 #include <memory>
-#include <unordered_map>
+#include <span>
+#include <vector>
 
 
 class SystemManager
@@ -13,56 +17,204 @@ public:
     template<typename T>
     std::shared_ptr<T> RegisterSystem()
     {
-        const char* typeName = typeid(T).name();
+        std::size_t index = TypeIndex<SystemFamily>::Get<T>();
 
-        assert(mSystems.find(typeName) == mSystems.end() && "Registering system more than once.");
+        if (index >= mSlots.size())
+        {
+            mSlots.resize(index + 1, UNREGISTERED);
+        }
+
+        assert(mSlots[index] == UNREGISTERED && "Registering system more than once.");
 
         auto system = std::make_shared<T>();
-        mSystems.insert({typeName, system});
+        mSlots[index] = mSystems.size();
+        mSystems.push_back(system);
+        mSignatures.emplace_back();
+        mAccesses.emplace_back();
+        RebuildIndex();
+        ++mVersion;
         return system;
     }
 
     template<typename T>
     void SetSignature(Signature signature)
     {
-        const char* typeName = typeid(T).name();
+        mSignatures[GetSlot<T>()] = signature;
+        RebuildIndex();
+    }
+
+    template<typename T>
+    void SetAccess(SystemAccess const& access)
+    {
+        mAccesses[GetSlot<T>()] = access;
+        ++mVersion;
+    }
 
-        assert(mSystems.find(typeName) != mSystems.end() && "System used before registered.");
+    // Registration order; the scheduler keeps conflicting systems in this order
+    std::vector<std::shared_ptr<System>> const& GetSystems() const { return mSystems; }
+    SystemAccess const& GetAccess(std::size_t slot) const { return mAccesses[slot]; }
 
-        mSignatures.insert({typeName, signature});
+    // Bumped whenever a system or its access changes, so schedules know when to rebuild
+    std::size_t GetVersion() const { return mVersion; }
+
+    // Only systems whose signature shares a component with the entity's can hold it
+    void EntityDestroyed(Entity entity, Signature entitySignature)
+    {
+        ForEachAffectedSystem(entitySignature, [&](std::size_t slot) {
+            auto& members = mSystems[slot]->mEntities;
+
+            if (members.Contains(entity))
+            {
+                members.Remove(entity);
+            }
+        });
     }
 
-    void EntityDestroyed(Entity entity)
+    // memberSignatures[i] is the signature systems last matched entities[i] against, which after a
+    // command buffer removed components may be wider than its current one. Their union picks the
+    // systems to visit; membership alone decides what is removed.
+    void EntitiesDestroyed(std::span<Entity const> entities, std::span<Signature const> memberSignatures)
     {
-        for (auto const& pair : mSystems)
+        Signature used;
+        for (auto const& signature : memberSignatures)
         {
-            auto const& system = pair.second;
+            used |= signature;
+        }
+
+        ForEachAffectedSystem(used, [&](std::size_t slot) {
+            auto& members = mSystems[slot]->mEntities;
+
+            for (Entity entity : entities)
+            {
+                if (members.Contains(entity))
+                {
+                    members.Remove(entity);
+                }
+            }
+        });
+    }
+
+    // Re-evaluates only the systems that care about a component that was added or removed, so a
+    // change to a component no system uses costs nothing
+    void EntitySignatureChanged(Entity entity, Signature oldSignature, Signature newSignature)
+    {
+        ForEachAffectedSystem(oldSignature ^ newSignature, [&](std::size_t slot) {
+            UpdateMembership(slot, entity, newSignature);
+        });
+    }
+
+    // Batch form: signatures[i] is the new signature of entities[i] and changed holds every bit that
+    // differs from the old signatures
+    void EntitiesSignatureChanged(std::span<Entity const> entities, std::span<Signature const> signatures, Signature changed)
+    {
+        ForEachAffectedSystem(changed, [&](std::size_t slot) {
+            for (std::size_t i = 0; i < entities.size(); ++i)
+            {
+                UpdateMembership(slot, entities[i], signatures[i]);
+            }
+        });
+    }
+
+private:
+    static constexpr std::size_t UNREGISTERED = std::numeric_limits<std::size_t>::max();
+
+    // TypeIndex<SystemFamily> -> position in the packed arrays below
+    std::vector<std::size_t> mSlots{};
+    std::vector<std::shared_ptr<System>> mSystems{};
+    std::vector<Signature> mSignatures{};
+    std::vector<SystemAccess> mAccesses{};
+    std::size_t mVersion{};
 
+    // Component bit -> slots of the systems whose signature includes it. Systems with an empty
+    // signature match every entity and are re-evaluated on any change.
+    std::array<std::vector<std::size_t>, MAX_COMPONENTS> mSystemsByComponent{};
+    std::vector<std::size_t> mWildcardSystems{};
 
-            system->mEntities.erase(entity);
+    // Stamp per slot so a system reached through several changed bits is visited once
+    std::vector<std::size_t> mVisited{};
+    std::size_t mVisitStamp{};
+
+
+    void RebuildIndex()
+    {
+        for (auto& systems : mSystemsByComponent)
+        {
+            systems.clear();
         }
+        mWildcardSystems.clear();
+
+        for (std::size_t slot = 0; slot < mSignatures.size(); ++slot)
+        {
+            if (mSignatures[slot].none())
+            {
+                mWildcardSystems.push_back(slot);
+            }
+
+            mSignatures[slot].ForEachSetBit([&](std::size_t type) {
+                mSystemsByComponent[type].push_back(slot);
+            });
+        }
+
+        mVisited.assign(mSignatures.size(), 0);
+        mVisitStamp = 0;
     }
 
-    void EntitySignatureChanged(Entity entity, Signature entitySignature)
+    // Calls fn(slot) once for every system whose signature includes one of bits, and for every
+    // wildcard system even when bits is empty: an entity whose last component was removed is still
+    // a member of those
+    template<typename Fn>
+    void ForEachAffectedSystem(Signature bits, Fn&& fn)
     {
-        for (auto const& pair : mSystems)
+        for (std::size_t slot : mWildcardSystems)
         {
-            auto const& type = pair.first;
-            auto const& system = pair.second;
-            auto const& systemSignature = mSignatures[type];
+            fn(slot);
+        }
+
+        if (bits.none())
+        {
+            return;
+        }
 
-            if ((entitySignature & systemSignature) == systemSignature)
+        ++mVisitStamp;
+
+        bits.ForEachSetBit([&](std::size_t type) {
+            for (std::size_t slot : mSystemsByComponent[type])
             {
-                system->mEntities.insert(entity);
+                if (mVisited[slot] != mVisitStamp)
+                {
+                    mVisited[slot] = mVisitStamp;
+                    fn(slot);
+                }
             }
-            else
+        });
+    }
+
+    void UpdateMembership(std::size_t slot, Entity entity, Signature entitySignature)
+    {
+        auto& members = mSystems[slot]->mEntities;
+        auto const& systemSignature = mSignatures[slot];
+        bool const member = members.Contains(entity);
+
+        if (entitySignature.Includes(systemSignature))
+        {
+            if (!member)
             {
-                system->mEntities.erase(entity);
+                members.Insert(entity);
             }
         }
+        else if (member)
+        {
+            members.Remove(entity);
+        }
     }
 
-private:
-    std::unordered_map<const char*, Signature> mSignatures{};
-    std::unordered_map<const char*, std::shared_ptr<System>> mSystems{};
+    template<typename T>
+    std::size_t GetSlot() const
+    {
+        std::size_t index = TypeIndex<SystemFamily>::Get<T>();
+
+        assert(index < mSlots.size() && mSlots[index] != UNREGISTERED && "System used before registered.");
+
+        return mSlots[index];
+    }
 };
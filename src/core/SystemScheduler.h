@@ -0,0 +1,166 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "SystemManager.h"
+#include "Types.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Runs every registered system once per frame. Two systems depend on each other when their declared
+// access conflicts (one writes a component the other reads or writes); conflicting systems run in
+// registration order, everything else runs in parallel on the job system. MainThread systems
+// always execute on the thread calling Run, one at a time and in registration order.
+class SystemScheduler
+{
+public:
+    explicit SystemScheduler(JobSystem& jobSystem)
+        : mJobSystem(jobSystem)
+    {}
+
+    // Rebuilds the dependency graph from the systems' declared access
+    void Build(SystemManager const& systemManager)
+    {
+        auto const& systems = systemManager.GetSystems();
+
+        mNodes.clear();
+        mMainThreadNodes.clear();
+
+        for (std::size_t i = 0; i < systems.size(); ++i)
+        {
+            auto node = std::make_unique<Node>();
+            node->scheduler = this;
+            node->system = systems[i].get();
+            node->access = systemManager.GetAccess(i);
+
+            for (std::size_t j = 0; j < i; ++j)
+            {
+                auto const& earlier = *mNodes[j];
+                bool const bothMainThread = earlier.access.affinity == ThreadAffinity::MainThread
+                    && node->access.affinity == ThreadAffinity::MainThread;
+
+                if (bothMainThread || earlier.access.ConflictsWith(node->access))
+                {
+                    mNodes[j]->dependents.push_back(node.get());
+                    ++node->dependencyCount;
+                }
+            }
+
+            mNodes.push_back(std::move(node));
+        }
+
+        mVersion = systemManager.GetVersion();
+    }
+
+    bool IsStale(SystemManager const& systemManager) const
+    {
+        return mNodes.empty() || mVersion != systemManager.GetVersion();
+    }
+
+    void Run(float deltaTime)
+    {
+        mDeltaTime = deltaTime;
+        mRemainingNodes.store(mNodes.size(), std::memory_order_relaxed);
+
+        for (auto& node : mNodes)
+        {
+            node->remaining.store(node->dependencyCount, std::memory_order_relaxed);
+        }
+
+        for (auto& node : mNodes)
+        {
+            if (node->dependencyCount == 0)
+            {
+                Schedule(*node);
+            }
+        }
+
+        // Run main-thread systems as they become ready and help the pool otherwise
+        while (mRemainingNodes.load(std::memory_order_acquire) != 0)
+        {
+            if (Node* node = PopMainThreadNode())
+            {
+                Execute(*node);
+            }
+            else if (!mJobSystem.RunPending())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct Node
+    {
+        SystemScheduler* scheduler{};
+        System* system{};
+        SystemAccess access{};
+        std::vector<Node*> dependents{};
+        std::size_t dependencyCount{};
+        std::atomic<std::size_t> remaining{};
+    };
+
+    JobSystem& mJobSystem;
+    std::vector<std::unique_ptr<Node>> mNodes{};
+    std::size_t mVersion{};
+
+    float mDeltaTime{};
+    std::atomic<std::size_t> mRemainingNodes{};
+
+    std::mutex mMainThreadMutex;
+    std::vector<Node*> mMainThreadNodes{};
+
+
+    void Schedule(Node& node)
+    {
+        if (node.access.affinity == ThreadAffinity::MainThread)
+        {
+            std::lock_guard lock(mMainThreadMutex);
+            mMainThreadNodes.push_back(&node);
+        }
+        else
+        {
+            mJobSystem.Submit(Job{
+                .function = [](void* context, std::size_t) {
+                    auto& node = *static_cast<Node*>(context);
+                    node.scheduler->Execute(node);
+                },
+                .context = &node
+            });
+        }
+    }
+
+    Node* PopMainThreadNode()
+    {
+        std::lock_guard lock(mMainThreadMutex);
+
+        if (mMainThreadNodes.empty())
+        {
+            return nullptr;
+        }
+
+        // Main-thread systems are chained, so at most one is ever ready
+        Node* node = mMainThreadNodes.back();
+        mMainThreadNodes.pop_back();
+        return node;
+    }
+
+    void Execute(Node& node)
+    {
+        node.system->Update(mDeltaTime);
+
+        for (Node* dependent : node.dependents)
+        {
+            if (dependent->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Schedule(*dependent);
+            }
+        }
+
+        mRemainingNodes.fetch_sub(1, std::memory_order_acq_rel);
+    }
+};
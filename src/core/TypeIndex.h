@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+
+// Dense per-family type indices (0, 1, 2, ...) handed out the first time a type is asked for.
+// The index lives in a function-local static of an inline template, so every translation unit
+// sees the same value for the same type and no RTTI is needed.
+template<typename Family>
+class TypeIndex
+{
+public:
+    template<typename T>
+    static std::size_t Get()
+    {
+        static const std::size_t index = sNextIndex.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+private:
+    static inline std::atomic<std::size_t> sNextIndex{0};
+};
+
+
+// Families
+struct ComponentFamily;
+struct SystemFamily;
+struct EventFamily;
+struct ResourceFamily;
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <bitset>
+#include "Signature.h"
+#include <cstddef>
 #include <cstdint>
 
 
@@ -16,12 +17,54 @@ constexpr std::uint32_t operator "" _hash(char const* s, std::size_t count)
 }
 
 
+// Alignment used to keep packed storage and per-thread data on separate cache lines
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+
 // ECS
-using Entity = std::uint32_t;
-const Entity MAX_ENTITIES = 5000;
-using ComponentType = std::uint8_t;
-const ComponentType MAX_COMPONENTS = 32;
-using Signature = std::bitset<MAX_COMPONENTS>;
+// An entity handle packs its slot index (low 32 bits) with the slot's version (high 32 bits). The
+// version is bumped when the entity is destroyed, so stale handles never alias a recycled slot.
+using Entity = std::uint64_t;
+using EntityIndex = std::uint32_t;
+using EntityVersion = std::uint32_t;
+
+constexpr Entity MakeEntity(EntityIndex index, EntityVersion version)
+{
+    return static_cast<Entity>(version) << 32 | index;
+}
+
+constexpr EntityIndex GetEntityIndex(Entity entity)
+{
+    return static_cast<EntityIndex>(entity);
+}
+
+constexpr EntityVersion GetEntityVersion(Entity entity)
+{
+    return static_cast<EntityVersion>(entity >> 32);
+}
+
+// Never returned by CreateEntity
+constexpr Entity NULL_ENTITY = ~Entity{0};
+
+// Default entity capacity; pass a different one to Mediator::Init. Storage grows with live entities.
+const EntityIndex MAX_ENTITIES = 5000;
+
+// Number of component types a signature can hold; configure with -DECS_MAX_COMPONENTS=<n>
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 128
+#endif
+
+using ComponentType = std::uint16_t;
+const ComponentType MAX_COMPONENTS = ECS_MAX_COMPONENTS;
+using Signature = BasicSignature<MAX_COMPONENTS>;
+
+// Component storage backend, chosen once in Mediator::Init:
+// Sparse keeps one packed array per component type, Archetype keeps one table per signature.
+enum class ComponentStorage
+{
+    Sparse,
+    Archetype
+};
 
 
 // Input
@@ -35,31 +78,3 @@ enum class InputButtons
     E
 };
 
-
-// Events
-using EventId = std::uint32_t;
-using ParamId = std::uint32_t;
-
-#define METHOD_LISTENER(EventType, Listener) EventType, std::bind(&Listener, this, std::placeholders::_1)
-#define FUNCTION_LISTENER(EventType, Listener) EventType, std::bind(&Listener, std::placeholders::_1)
-
-// TODO: Make these easier to define and use (macro?)
-// TODO: Add some kind of enforcement/automation that a SetParam type and a GetParam type match
-
-namespace Events::Window {
-const EventId QUIT = "Events::Window::QUIT"_hash;
-const EventId RESIZED = "Events::Window::RESIZED"_hash;
-const EventId KEYDOWN = "Events::Window::KEYDOWN"_hash;
-const EventId MOUSEMOVE = "Events::Window::MOUSEMOVE"_hash;
-}
-
-namespace Events::Window::Input {
-const ParamId KEYS_DOWN = "Events::Window::Input::KEYS_DOWN"_hash;
-const ParamId MOUSE_XOFFSET =  "Events::Window::Input::MOUSE_XOFFSET"_hash;
-const ParamId MOUSE_YOFFSET =  "Events::Window::Input::MOUSE_YOFFSET"_hash;
-}
-
-namespace Events::Window::Resized {
-const ParamId WIDTH = "Events::Window::Resized::WIDTH"_hash;
-const ParamId HEIGHT = "Events::Window::Resized::HEIGHT"_hash;
-}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "ArchetypeManager.h"
+#include "ChangeTracker.h"
+#include "ComponentArray.h"
+#include "JobSystem.h"
+#include "Types.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Iterates every entity that has all of Ts. The component storage is resolved once when the view is
+// created, so the loop itself does no type lookups and hands out references straight from storage.
+// A const-qualified T (View<Transform const>) is read-only. A non-const T whose type tracks changes
+// stamps every visited entity as changed, whether or not fn actually writes it.
+//
+// Adding or removing components, or destroying entities, while a view is iterating is not allowed.
+template<typename... Ts>
+class View
+{
+public:
+    static_assert(sizeof...(Ts) > 0, "A view needs at least one component type.");
+
+    using ChangeTrackers = std::array<ChangeTracker*, sizeof...(Ts)>;
+
+    // Sparse storage: one packed array per component type
+    explicit View(ComponentArray<std::remove_const_t<Ts>>*... arrays)
+        : mArrays(arrays...)
+    {}
+
+    // trackers[i] is stamped for every entity visited, or null for Ts[i] that are not written or tracked
+    View(ChangeTrackers const& trackers, ComponentArray<std::remove_const_t<Ts>>*... arrays)
+        : mArrays(arrays...)
+    {
+        SetChangeTrackers(trackers);
+    }
+
+    // Archetype storage: every table whose signature includes all of types
+    View(ArchetypeManager* archetypes, std::array<ComponentType, sizeof...(Ts)> const& types, ChangeTrackers const& trackers = {})
+        : mArchetypes(archetypes), mTypes(types)
+    {
+        SetChangeTrackers(trackers);
+
+        for (ComponentType type : types)
+        {
+            mSignature.set(type);
+        }
+    }
+
+    // fn(Entity, Ts&...) or fn(Ts&...)
+    template<typename Fn>
+    void Each(Fn&& fn) const
+    {
+        if (mArchetypes)
+        {
+            mArchetypes->ForEachArchetype(mSignature, [&](Archetype& archetype) {
+                EachRow(fn, archetype, 0, archetype.Size(), std::index_sequence_for<Ts...>{});
+            });
+        }
+        else
+        {
+            std::size_t alignment;
+            SparseSet const* driver = SelectDriver(alignment, std::index_sequence_for<Ts...>{});
+            EachDense(fn, *driver, 0, driver->Size());
+        }
+    }
+
+    // Each, split into chunks that run on the job system; returns once every chunk is done. fn must
+    // be safe to call concurrently for different entities.
+    //
+    // Chunk boundaries fall on cache-line boundaries of the packed arrays, so two chunks never write
+    // to the same line. In sparse storage this holds for the smallest (driving) pool; the others are
+    // probed per entity, so pack them with Mediator::SortComponents to get the same guarantee.
+    // grainSize is the minimum number of entities per chunk; 0 picks one from the worker count.
+    template<typename Fn>
+    void ParallelEach(JobSystem& jobSystem, Fn&& fn, std::size_t grainSize = 0) const
+    {
+        using Function = std::remove_reference_t<Fn>;
+
+        // Whole ranges first: one per matching archetype, or the driving pool's dense array
+        std::vector<Range> ranges;
+        ParallelContext<Function> context{this, &fn};
+
+        if (mArchetypes)
+        {
+            mArchetypes->ForEachArchetype(mSignature, [&](Archetype& archetype) {
+                ranges.push_back(Range{&archetype, 0, archetype.Size(), archetype.CacheLineRows()});
+            });
+        }
+        else
+        {
+            std::size_t alignment;
+            context.driver = SelectDriver(alignment, std::index_sequence_for<Ts...>{});
+            ranges.push_back(Range{nullptr, 0, context.driver->Size(), alignment});
+        }
+
+        if (grainSize == 0)
+        {
+            // A few chunks per thread so stealing can even out the load
+            std::size_t total = 0;
+            for (Range const& range : ranges)
+            {
+                total += range.end;
+            }
+
+            std::size_t chunkCount = (jobSystem.WorkerCount() + 1) * 4;
+            grainSize = std::max<std::size_t>(256, (total + chunkCount - 1) / chunkCount);
+        }
+
+        // Then cut them into chunks whose size is rounded up to a whole number of cache lines
+        for (Range const& range : ranges)
+        {
+            std::size_t step = (grainSize + range.alignment - 1) / range.alignment * range.alignment;
+
+            for (std::size_t begin = range.begin; begin < range.end; begin += step)
+            {
+                context.chunks.push_back(Range{range.archetype, begin, std::min(range.end, begin + step), range.alignment});
+            }
+        }
+
+        if (context.chunks.size() <= 1)
+        {
+            for (std::size_t i = 0; i < context.chunks.size(); ++i)
+            {
+                RunChunk<Function>(&context, i);
+            }
+            return;
+        }
+
+        JobCounter counter;
+        for (std::size_t i = 0; i < context.chunks.size(); ++i)
+        {
+            jobSystem.Submit(Job{
+                .function = &RunChunk<Function>,
+                .context = &context,
+                .index = i,
+                .counter = &counter
+            });
+        }
+
+        jobSystem.Wait(counter);
+    }
+
+private:
+    // Rows [begin, end) of one archetype, or dense indices of the driving pool when archetype is null
+    struct Range
+    {
+        Archetype* archetype{};
+        std::size_t begin{};
+        std::size_t end{};
+        std::size_t alignment{};
+    };
+
+    template<typename Fn>
+    struct ParallelContext
+    {
+        View const* view{};
+        Fn* fn{};
+        SparseSet const* driver{};
+        std::vector<Range> chunks{};
+    };
+
+    std::tuple<ComponentArray<std::remove_const_t<Ts>>*...> mArrays{};
+    ArchetypeManager* mArchetypes{};
+    std::array<ComponentType, sizeof...(Ts)> mTypes{};
+    Signature mSignature{};
+    ChangeTrackers mChangeTrackers{};
+    bool mTracksChanges{};
+
+
+    void SetChangeTrackers(ChangeTrackers const& trackers)
+    {
+        mChangeTrackers = trackers;
+        mTracksChanges = std::any_of(trackers.begin(), trackers.end(), [](ChangeTracker* tracker) { return tracker != nullptr; });
+    }
+
+
+    // Elements of this size that are a multiple of the result apart never share a cache line
+    static constexpr std::size_t CacheLineElements(std::size_t size)
+    {
+        return CACHE_LINE_SIZE / std::gcd(CACHE_LINE_SIZE, size);
+    }
+
+    template<typename Fn>
+    void Invoke(Fn& fn, Entity entity, Ts&... components) const
+    {
+        if (mTracksChanges)
+        {
+            for (ChangeTracker* tracker : mChangeTrackers)
+            {
+                if (tracker)
+                {
+                    tracker->MarkChanged(entity);
+                }
+            }
+        }
+
+        if constexpr (std::is_invocable_v<Fn&, Entity, Ts&...>)
+        {
+            fn(entity, components...);
+        }
+        else
+        {
+            fn(components...);
+        }
+    }
+
+    template<typename Fn>
+    static void RunChunk(void* context, std::size_t index)
+    {
+        auto const& parallel = *static_cast<ParallelContext<Fn>*>(context);
+        Range const& chunk = parallel.chunks[index];
+
+        if (chunk.archetype)
+        {
+            parallel.view->EachRow(*parallel.fn, *chunk.archetype, chunk.begin, chunk.end, std::index_sequence_for<Ts...>{});
+        }
+        else
+        {
+            parallel.view->EachDense(*parallel.fn, *parallel.driver, chunk.begin, chunk.end);
+        }
+    }
+
+    // The smallest pool drives sparse iteration; every other pool is only probed
+    template<std::size_t... Is>
+    SparseSet const* SelectDriver(std::size_t& alignment, std::index_sequence<Is...>) const
+    {
+        SparseSet const* driver = nullptr;
+
+        auto consider = [&](auto* array, std::size_t elementSize) {
+            if (!driver || array->Size() < driver->Size())
+            {
+                driver = &array->Entities();
+                alignment = CacheLineElements(elementSize);
+            }
+        };
+        (consider(std::get<Is>(mArrays), sizeof(std::remove_const_t<Ts>)), ...);
+
+        return driver;
+    }
+
+    template<typename Fn>
+    void EachDense(Fn& fn, SparseSet const& driver, std::size_t begin, std::size_t end) const
+    {
+        if constexpr (sizeof...(Ts) == 1)
+        {
+            // A single pool is exactly its packed arrays
+            auto* array = std::get<0>(mArrays);
+
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                Invoke(fn, driver.At(i), array->GetDataAt(i));
+            }
+        }
+        else
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                Entity entity = driver.At(i);
+
+                if ((std::get<ComponentArray<std::remove_const_t<Ts>>*>(mArrays)->HasData(entity) && ...))
+                {
+                    Invoke(fn, entity, std::get<ComponentArray<std::remove_const_t<Ts>>*>(mArrays)->GetData(entity)...);
+                }
+            }
+        }
+    }
+
+    template<typename Fn, std::size_t... Is>
+    void EachRow(Fn& fn, Archetype& archetype, std::size_t begin, std::size_t end, std::index_sequence<Is...>) const
+    {
+        std::tuple<std::remove_const_t<Ts>*...> columns{archetype.ColumnData<std::remove_const_t<Ts>>(mTypes[Is])...};
+        auto const& entities = archetype.Entities();
+
+        for (std::size_t row = begin; row < end; ++row)
+        {
+            Invoke(fn, entities[row], std::get<Is>(columns)[row]...);
+        }
+    }
+};
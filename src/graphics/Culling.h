@@ -0,0 +1,321 @@
+#pragma once
+
+#include "TransformMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// World-space bounding spheres, one array per field so the culling pass loads a register's worth of
+// spheres per field
+struct SphereSoA
+{
+    std::vector<float> centerX{};
+    std::vector<float> centerY{};
+    std::vector<float> centerZ{};
+    std::vector<float> radius{};
+
+    std::size_t Size() const { return centerX.size(); }
+
+    void Resize(std::size_t size)
+    {
+        for (auto* field : {&centerX, &centerY, &centerZ, &radius})
+        {
+            field->resize(size);
+        }
+    }
+
+    void Set(std::size_t index, float x, float y, float z, float r)
+    {
+        centerX[index] = x;
+        centerY[index] = y;
+        centerZ[index] = z;
+        radius[index] = r;
+    }
+};
+
+
+// Axis-aligned box
+struct Aabb
+{
+    float min[3]{};
+    float max[3]{};
+
+    bool Contains(Aabb const& other) const
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (other.min[axis] < min[axis] || other.max[axis] > max[axis])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Overlaps(Aabb const& other) const
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (other.max[axis] < min[axis] || other.min[axis] > max[axis])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Half the surface area; only ever compared, so the factor does not matter
+    float Area() const
+    {
+        float dx = max[0] - min[0];
+        float dy = max[1] - min[1];
+        float dz = max[2] - min[2];
+
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    Aabb Fattened(float margin) const
+    {
+        Aabb result = *this;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            result.min[axis] -= margin;
+            result.max[axis] += margin;
+        }
+
+        return result;
+    }
+
+    float DistanceSquared(float const* point) const
+    {
+        float distance = 0.0f;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float outside = std::max({min[axis] - point[axis], 0.0f, point[axis] - max[axis]});
+            distance += outside * outside;
+        }
+
+        return distance;
+    }
+
+    // Where the ray origin + t * direction, t in [0, maxDistance], enters the box: 0 from inside, a
+    // negative value on a miss. inverseDirection is 1 / direction per axis.
+    float RayEntry(float const* origin, float const* inverseDirection, float maxDistance) const
+    {
+        float enter = 0.0f;
+        float exit = maxDistance;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float t1 = (min[axis] - origin[axis]) * inverseDirection[axis];
+            float t2 = (max[axis] - origin[axis]) * inverseDirection[axis];
+
+            enter = std::max(enter, std::min(t1, t2));
+            exit = std::min(exit, std::max(t1, t2));
+        }
+
+        return enter <= exit ? enter : -1.0f;
+    }
+
+    static Aabb Union(Aabb const& a, Aabb const& b)
+    {
+        Aabb result;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            result.min[axis] = std::min(a.min[axis], b.min[axis]);
+            result.max[axis] = std::max(a.max[axis], b.max[axis]);
+        }
+
+        return result;
+    }
+
+    // The box around a local box carried through a column-major world matrix: the center is
+    // transformed and each world extent sums the local extents weighted by |matrix|
+    static Aabb Transformed(float const* world, Aabb const& local)
+    {
+        Aabb result;
+
+        for (int row = 0; row < 3; ++row)
+        {
+            float center = world[12 + row];
+            float extent = 0.0f;
+
+            for (int column = 0; column < 3; ++column)
+            {
+                float m = world[4 * column + row];
+                center += m * 0.5f * (local.min[column] + local.max[column]);
+                extent += std::fabs(m) * 0.5f * (local.max[column] - local.min[column]);
+            }
+
+            result.min[row] = center - extent;
+            result.max[row] = center + extent;
+        }
+
+        return result;
+    }
+};
+
+
+// Six planes (a, b, c, d) facing inwards: a point is inside a plane when a*x + b*y + c*z + d >= 0.
+// The normals are unit length, so that expression is the signed distance.
+struct Frustum
+{
+    float planes[6][4]{};
+};
+
+
+namespace Culling {
+
+enum class Containment
+{
+    Outside,
+    Intersects,
+    Inside
+};
+
+// The frustum of a column-major view-projection matrix with OpenGL clip space (-w <= x, y, z <= w):
+// each plane is the fourth row plus or minus one of the others
+inline Frustum ExtractFrustum(float const* viewProjection)
+{
+    auto row = [&](int index, int element) { return viewProjection[4 * element + index]; };
+
+    Frustum frustum;
+
+    for (int plane = 0; plane < 6; ++plane)
+    {
+        int const axis = plane / 2;
+        float const sign = plane % 2 == 0 ? 1.0f : -1.0f;
+
+        for (int element = 0; element < 4; ++element)
+        {
+            frustum.planes[plane][element] = row(3, element) + sign * row(axis, element);
+        }
+
+        float* p = frustum.planes[plane];
+        float length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+        for (int element = 0; element < 4; ++element)
+        {
+            p[element] /= length;
+        }
+    }
+
+    return frustum;
+}
+
+// A local sphere carried through a column-major world matrix. The radius grows by the largest axis
+// scale, so the result still encloses the transformed geometry under non-uniform scale.
+inline void WorldSphere(float const* world, float x, float y, float z, float r, float& outX, float& outY, float& outZ, float& outR)
+{
+    outX = world[0] * x + world[4] * y + world[8] * z + world[12];
+    outY = world[1] * x + world[5] * y + world[9] * z + world[13];
+    outZ = world[2] * x + world[6] * y + world[10] * z + world[14];
+
+    float scale = 0.0f;
+    for (int column = 0; column < 3; ++column)
+    {
+        float const* axis = world + 4 * column;
+        scale = std::max(scale, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    }
+
+    outR = r * std::sqrt(scale);
+}
+
+// Conservative: true unless the sphere is entirely behind one of the planes
+inline bool Visible(Frustum const& frustum, float x, float y, float z, float r)
+{
+    for (auto const& p : frustum.planes)
+    {
+        if (p[0] * x + p[1] * y + p[2] * z + p[3] < -r)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Per plane, the box corner farthest along the normal decides whether the box is outside and the
+// nearest one whether it is inside. Conservative near the frustum's edges, like Visible.
+inline Containment Classify(Frustum const& frustum, Aabb const& box)
+{
+    bool inside = true;
+
+    for (auto const& p : frustum.planes)
+    {
+        float farthest = p[3];
+        float nearest = p[3];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            farthest += p[axis] * (p[axis] >= 0.0f ? box.max[axis] : box.min[axis]);
+            nearest += p[axis] * (p[axis] >= 0.0f ? box.min[axis] : box.max[axis]);
+        }
+
+        if (farthest < 0.0f)
+        {
+            return Containment::Outside;
+        }
+
+        inside = inside && nearest >= 0.0f;
+    }
+
+    return inside ? Containment::Inside : Containment::Intersects;
+}
+
+// Appends, in order, the index of every sphere in [begin, end) that Visible accepts. LANES spheres
+// per step: the smallest distance plus radius over the six planes is negative exactly when a sphere is
+// outside, so its sign bit marks the lanes to drop.
+inline void CullSpheres(Frustum const& frustum, SphereSoA const& spheres, std::size_t begin, std::size_t end, std::vector<std::uint32_t>& visible)
+{
+    std::size_t i = begin;
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+    using namespace TransformMath::Detail;
+
+    for (; i + LANES <= end; i += LANES)
+    {
+        Floats x = Load(&spheres.centerX[i]);
+        Floats y = Load(&spheres.centerY[i]);
+        Floats z = Load(&spheres.centerZ[i]);
+        Floats r = Load(&spheres.radius[i]);
+
+        Floats nearest = Set(0.0f);
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            float const* p = frustum.planes[plane];
+            Floats distance = Add(Add(Mul(Set(p[0]), x), Mul(Set(p[1]), y)), Add(Mul(Set(p[2]), z), Set(p[3])));
+            Floats margin = Add(distance, r);
+            nearest = plane == 0 ? margin : Min(nearest, margin);
+        }
+
+        unsigned outside = static_cast<unsigned>(SignMask(nearest));
+
+        for (std::size_t lane = 0; lane < LANES; ++lane)
+        {
+            if (!(outside & (1u << lane)))
+            {
+                visible.push_back(static_cast<std::uint32_t>(i + lane));
+            }
+        }
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        if (Visible(frustum, spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i], spheres.radius[i]))
+        {
+            visible.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+}
@@ -0,0 +1,463 @@
+#pragma once
+
+#include "Culling.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+// Bounding volume hierarchy over boxes that move. Every leaf (proxy) stores its box grown by a
+// margin, so a box that moves a little still fits and MoveProxy returns without touching the tree;
+// only a box that leaves its fat box is removed and reinserted. Insertion descends toward the
+// sibling that grows the tree's surface area least, and AVL rotations on the way back up keep the
+// height logarithmic. Queries walk the tree depth first and skip every subtree whose box misses.
+class DynamicAabbTree
+{
+public:
+    static constexpr std::int32_t NULL_NODE = -1;
+
+    explicit DynamicAabbTree(float margin = 0.1f) : mMargin(margin) {}
+
+    std::int32_t CreateProxy(Aabb const& aabb, std::uint32_t userData)
+    {
+        std::int32_t proxy = AllocateNode();
+
+        mNodes[proxy].aabb = aabb.Fattened(mMargin);
+        mNodes[proxy].userData = userData;
+        mNodes[proxy].height = 0;
+
+        InsertLeaf(proxy);
+        ++mProxyCount;
+
+        return proxy;
+    }
+
+    void DestroyProxy(std::int32_t proxy)
+    {
+        assert(mNodes[proxy].IsLeaf() && "Not a proxy.");
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        --mProxyCount;
+    }
+
+    // True if the proxy was reinserted, false if aabb still fits its fat box
+    bool MoveProxy(std::int32_t proxy, Aabb const& aabb)
+    {
+        assert(mNodes[proxy].IsLeaf() && "Not a proxy.");
+
+        if (mNodes[proxy].aabb.Contains(aabb))
+        {
+            return false;
+        }
+
+        RemoveLeaf(proxy);
+        mNodes[proxy].aabb = aabb.Fattened(mMargin);
+        InsertLeaf(proxy);
+
+        return true;
+    }
+
+    std::uint32_t GetUserData(std::int32_t proxy) const { return mNodes[proxy].userData; }
+
+    Aabb const& GetFatAabb(std::int32_t proxy) const { return mNodes[proxy].aabb; }
+
+    std::size_t Size() const { return mProxyCount; }
+
+    std::int32_t Height() const { return mRoot == NULL_NODE ? 0 : mNodes[mRoot].height; }
+
+    // fn(userData) for every proxy whose fat box touches the frustum. Subtrees entirely inside are
+    // reported without testing their boxes.
+    template<typename Fn>
+    void QueryFrustum(Frustum const& frustum, Fn&& fn) const
+    {
+        Stack stack;
+        stack.Push(mRoot);
+
+        while (!stack.Empty())
+        {
+            std::int32_t index = stack.Pop();
+            Node const& node = mNodes[index];
+
+            auto containment = Culling::Classify(frustum, node.aabb);
+
+            if (containment == Culling::Containment::Outside)
+            {
+                continue;
+            }
+
+            if (containment == Culling::Containment::Inside || node.IsLeaf())
+            {
+                ReportSubtree(index, fn);
+                continue;
+            }
+
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+
+    // fn(userData) for every proxy whose fat box overlaps aabb
+    template<typename Fn>
+    void QueryAabb(Aabb const& aabb, Fn&& fn) const
+    {
+        Stack stack;
+        stack.Push(mRoot);
+
+        while (!stack.Empty())
+        {
+            Node const& node = mNodes[stack.Pop()];
+
+            if (!node.aabb.Overlaps(aabb))
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                fn(node.userData);
+                continue;
+            }
+
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+
+    // fn(userData, entryDistance) for every proxy whose fat box the ray origin + t * direction enters
+    // within maxDistance. fn returns the new maxDistance: the same to keep going, less to clip the ray
+    // (at a confirmed hit, say), 0 to stop.
+    template<typename Fn>
+    void RayCast(float const* origin, float const* direction, float maxDistance, Fn&& fn) const
+    {
+        float inverseDirection[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            inverseDirection[axis] = 1.0f / direction[axis];
+        }
+
+        Stack stack;
+        stack.Push(mRoot);
+
+        while (!stack.Empty())
+        {
+            Node const& node = mNodes[stack.Pop()];
+
+            float entry = node.aabb.RayEntry(origin, inverseDirection, maxDistance);
+
+            if (entry < 0.0f)
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                maxDistance = fn(node.userData, entry);
+
+                if (maxDistance <= 0.0f)
+                {
+                    return;
+                }
+                continue;
+            }
+
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+
+private:
+    struct Node
+    {
+        Aabb aabb{};
+        std::uint32_t userData{};
+
+        // The next free node while on the free list
+        std::int32_t parent = NULL_NODE;
+        std::int32_t child1 = NULL_NODE;
+        std::int32_t child2 = NULL_NODE;
+
+        // 0 for leaves, -1 while free
+        std::int32_t height = -1;
+
+        bool IsLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    // Depth-first traversal holds at most one pending sibling per level; an AVL-balanced tree of a
+    // billion proxies is under 45 levels deep
+    struct Stack
+    {
+        std::array<std::int32_t, 128> items;
+        std::size_t size = 0;
+
+        bool Empty() const { return size == 0; }
+
+        void Push(std::int32_t index)
+        {
+            if (index == NULL_NODE)
+            {
+                return;
+            }
+
+            assert(size < items.size() && "Tree too deep.");
+            items[size++] = index;
+        }
+
+        std::int32_t Pop() { return items[--size]; }
+    };
+
+    template<typename Fn>
+    void ReportSubtree(std::int32_t index, Fn& fn) const
+    {
+        Stack stack;
+        stack.Push(index);
+
+        while (!stack.Empty())
+        {
+            Node const& node = mNodes[stack.Pop()];
+
+            if (node.IsLeaf())
+            {
+                fn(node.userData);
+                continue;
+            }
+
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+
+    std::int32_t AllocateNode()
+    {
+        if (mFreeList == NULL_NODE)
+        {
+            assert(mNodes.size() < static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()) && "Too many nodes.");
+
+            mNodes.emplace_back();
+            return static_cast<std::int32_t>(mNodes.size() - 1);
+        }
+
+        std::int32_t index = mFreeList;
+        mFreeList = mNodes[index].parent;
+        mNodes[index] = Node{};
+
+        return index;
+    }
+
+    void FreeNode(std::int32_t index)
+    {
+        mNodes[index].parent = mFreeList;
+        mNodes[index].height = -1;
+        mFreeList = index;
+    }
+
+    // Cost of pushing the new leaf down into child: the area the child's box would gain, or for a
+    // leaf child the area of the new parent the two would share
+    float DescendCost(std::int32_t child, Aabb const& leafAabb) const
+    {
+        Node const& node = mNodes[child];
+        float area = Aabb::Union(leafAabb, node.aabb).Area();
+
+        return node.IsLeaf() ? area : area - node.aabb.Area();
+    }
+
+    void InsertLeaf(std::int32_t leaf)
+    {
+        if (mRoot == NULL_NODE)
+        {
+            mRoot = leaf;
+            mNodes[leaf].parent = NULL_NODE;
+            return;
+        }
+
+        // Find the best sibling
+        Aabb const leafAabb = mNodes[leaf].aabb;
+        std::int32_t index = mRoot;
+
+        while (!mNodes[index].IsLeaf())
+        {
+            Node const& node = mNodes[index];
+
+            float area = node.aabb.Area();
+            float combinedArea = Aabb::Union(node.aabb, leafAabb).Area();
+
+            // Pairing the leaf with this node, versus the growth every level below would inherit
+            float cost = 2.0f * combinedArea;
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float cost1 = DescendCost(node.child1, leafAabb) + inheritanceCost;
+            float cost2 = DescendCost(node.child2, leafAabb) + inheritanceCost;
+
+            if (cost < cost1 && cost < cost2)
+            {
+                break;
+            }
+
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        std::int32_t sibling = index;
+        std::int32_t oldParent = mNodes[sibling].parent;
+
+        // AllocateNode may grow mNodes, so no references are held across it
+        std::int32_t newParent = AllocateNode();
+        mNodes[newParent].parent = oldParent;
+        mNodes[newParent].aabb = Aabb::Union(leafAabb, mNodes[sibling].aabb);
+        mNodes[newParent].height = mNodes[sibling].height + 1;
+        mNodes[newParent].child1 = sibling;
+        mNodes[newParent].child2 = leaf;
+
+        if (oldParent == NULL_NODE)
+        {
+            mRoot = newParent;
+        }
+        else if (mNodes[oldParent].child1 == sibling)
+        {
+            mNodes[oldParent].child1 = newParent;
+        }
+        else
+        {
+            mNodes[oldParent].child2 = newParent;
+        }
+
+        mNodes[sibling].parent = newParent;
+        mNodes[leaf].parent = newParent;
+
+        Refit(mNodes[leaf].parent);
+    }
+
+    void RemoveLeaf(std::int32_t leaf)
+    {
+        if (leaf == mRoot)
+        {
+            mRoot = NULL_NODE;
+            return;
+        }
+
+        std::int32_t parent = mNodes[leaf].parent;
+        std::int32_t grandParent = mNodes[parent].parent;
+        std::int32_t sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+
+        // The sibling takes the parent's place
+        if (grandParent == NULL_NODE)
+        {
+            mRoot = sibling;
+        }
+        else if (mNodes[grandParent].child1 == parent)
+        {
+            mNodes[grandParent].child1 = sibling;
+        }
+        else
+        {
+            mNodes[grandParent].child2 = sibling;
+        }
+
+        mNodes[sibling].parent = grandParent;
+        FreeNode(parent);
+
+        Refit(grandParent);
+    }
+
+    // Rebalances and recomputes boxes and heights from index up to the root
+    void Refit(std::int32_t index)
+    {
+        while (index != NULL_NODE)
+        {
+            index = Balance(index);
+
+            Node& node = mNodes[index];
+            Node const& child1 = mNodes[node.child1];
+            Node const& child2 = mNodes[node.child2];
+
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.aabb = Aabb::Union(child1.aabb, child2.aabb);
+
+            index = node.parent;
+        }
+    }
+
+    // If one child of a is more than one level taller than the other, rotates that child up into
+    // a's place, and returns the index now at the top of the subtree
+    std::int32_t Balance(std::int32_t iA)
+    {
+        Node& a = mNodes[iA];
+
+        if (a.IsLeaf() || a.height < 2)
+        {
+            return iA;
+        }
+
+        std::int32_t iB = a.child1;
+        std::int32_t iC = a.child2;
+        std::int32_t balance = mNodes[iC].height - mNodes[iB].height;
+
+        if (balance > 1)
+        {
+            RotateUp(iA, iC, iB, false);
+            return iC;
+        }
+
+        if (balance < -1)
+        {
+            RotateUp(iA, iB, iC, true);
+            return iB;
+        }
+
+        return iA;
+    }
+
+    // Makes up (a child of a) the parent of a. a keeps other and the shorter of up's children; up
+    // keeps the taller one. upIsChild1 says which of a's children up was.
+    void RotateUp(std::int32_t iA, std::int32_t iUp, std::int32_t iOther, bool upIsChild1)
+    {
+        Node& a = mNodes[iA];
+        Node& up = mNodes[iUp];
+        Node const& other = mNodes[iOther];
+
+        std::int32_t iF = up.child1;
+        std::int32_t iG = up.child2;
+
+        // up replaces a under a's parent
+        up.child1 = iA;
+        up.parent = a.parent;
+        a.parent = iUp;
+
+        if (up.parent == NULL_NODE)
+        {
+            mRoot = iUp;
+        }
+        else if (mNodes[up.parent].child1 == iA)
+        {
+            mNodes[up.parent].child1 = iUp;
+        }
+        else
+        {
+            mNodes[up.parent].child2 = iUp;
+        }
+
+        std::int32_t iTaller = mNodes[iF].height > mNodes[iG].height ? iF : iG;
+        std::int32_t iShorter = iTaller == iF ? iG : iF;
+        Node& taller = mNodes[iTaller];
+        Node& shorter = mNodes[iShorter];
+
+        up.child2 = iTaller;
+        (upIsChild1 ? a.child1 : a.child2) = iShorter;
+        shorter.parent = iA;
+
+        a.aabb = Aabb::Union(other.aabb, shorter.aabb);
+        up.aabb = Aabb::Union(a.aabb, taller.aabb);
+
+        a.height = 1 + std::max(other.height, shorter.height);
+        up.height = 1 + std::max(a.height, taller.height);
+    }
+
+    std::vector<Node> mNodes;
+    std::int32_t mRoot = NULL_NODE;
+    std::int32_t mFreeList = NULL_NODE;
+    std::size_t mProxyCount{};
+    float mMargin;
+};
@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include <algorithm>
 #include <iostream>
 #include <glm/ext/scalar_constants.hpp>
 
@@ -8,10 +9,45 @@ Mesh::Mesh (std::vector<Vertex> vertices,
     this->vertices = vertices;
     this->indices  = indices;
     this->textures = textures;
+    this->bounds   = Bounds::fromVertices (this->vertices);
 
     this->setup ();
 }
 
+Bounds Bounds::fromVertices (const std::vector<Vertex>& vertices) {
+    Bounds bounds;
+
+    if (vertices.empty ()) {
+        return bounds;
+    }
+
+    bounds.Min = vertices[0].Position;
+    bounds.Max = vertices[0].Position;
+    for (const auto& vertex : vertices) {
+        bounds.Min = glm::min (bounds.Min, vertex.Position);
+        bounds.Max = glm::max (bounds.Max, vertex.Position);
+    }
+
+    // Centered on the box, but only as large as the farthest vertex needs
+    bounds.Center = (bounds.Min + bounds.Max) * 0.5f;
+    for (const auto& vertex : vertices) {
+        bounds.Radius = std::max (bounds.Radius, glm::length (vertex.Position - bounds.Center));
+    }
+
+    return bounds;
+}
+
+Bounds Bounds::merge (const Bounds& a, const Bounds& b) {
+    Bounds bounds;
+    bounds.Min    = glm::min (a.Min, b.Min);
+    bounds.Max    = glm::max (a.Max, b.Max);
+    bounds.Center = (bounds.Min + bounds.Max) * 0.5f;
+    bounds.Radius = std::max (glm::length (a.Center - bounds.Center) + a.Radius,
+        glm::length (b.Center - bounds.Center) + b.Radius);
+
+    return bounds;
+}
+
 void Mesh::setup () {
     glGenVertexArrays (1, &VAO);
     glGenBuffers (1, &VBO);
@@ -46,13 +82,57 @@ void Mesh::setup () {
 }
 
 void Mesh::draw (Shader& shader) const {
+    bindTextures (shader);
+
+    // draw mesh
+    glBindVertexArray (VAO);
+    glDrawElements (GL_TRIANGLES, static_cast<unsigned int> (indices.size ()),
+        GL_UNSIGNED_INT, 0);
+    glBindVertexArray (0);
+
+    //  set everything back to defaults once configured
+    glActiveTexture (GL_TEXTURE0);
+}
+
+void Mesh::drawInstanced (Shader& shader, GLuint instanceBuffer,
+    std::size_t firstInstance, GLsizei count) const {
+    bindTextures (shader);
+
+    glBindVertexArray (VAO);
+    glBindBuffer (GL_ARRAY_BUFFER, instanceBuffer);
+
+    // Point the per-instance attributes at this draw's range of the buffer
+    std::size_t base = firstInstance * sizeof (InstanceData);
+
+    // Model matrix, one column per attribute
+    for (GLuint column = 0; column < 4; column++) {
+        glEnableVertexAttribArray (3 + column);
+        glVertexAttribPointer (3 + column, 4, GL_FLOAT, GL_FALSE, sizeof (InstanceData),
+            (void*)(base + offsetof (InstanceData, Model) + column * sizeof (glm::vec4)));
+        glVertexAttribDivisor (3 + column, 1);
+    }
+
+    // Color
+    glEnableVertexAttribArray (7);
+    glVertexAttribPointer (7, 4, GL_FLOAT, GL_FALSE, sizeof (InstanceData),
+        (void*)(base + offsetof (InstanceData, Color)));
+    glVertexAttribDivisor (7, 1);
+
+    glDrawElementsInstanced (GL_TRIANGLES, static_cast<GLsizei> (indices.size ()),
+        GL_UNSIGNED_INT, 0, count);
+    glBindVertexArray (0);
+
+    glActiveTexture (GL_TEXTURE0);
+}
+
+void Mesh::bindTextures (Shader& shader) const {
     // bind appropriate textures
     unsigned int diffuseNr  = 1;
     unsigned int specularNr = 1;
     unsigned int normalNr   = 1;
     unsigned int heightNr   = 1;
 
-    glUniform1i(glGetUniformLocation(shader.getID(), "uHasTexture"), false);
+    shader.setUniform("uHasTexture"_hash, false);
     for (unsigned int i = 0; i < textures.size (); i++) {
         glActiveTexture (GL_TEXTURE0 + i);
         // active proper texture unit before binding
@@ -70,20 +150,11 @@ void Mesh::draw (Shader& shader) const {
         // transfer unsigned int to string
 
         // now set the sampler to the correct texture unit
-        shader.setUniform("uTexture", i);
-        glUniform1i(glGetUniformLocation(shader.getID(), "uHasTexture"), true);
+        shader.setUniform("uTexture"_hash, i);
+        shader.setUniform("uHasTexture"_hash, true);
 
 
         // and finally bind the texture
         glBindTexture (GL_TEXTURE_2D, textures[i].id);
     }
-
-    // draw mesh
-    glBindVertexArray (VAO);
-    glDrawElements (GL_TRIANGLES, static_cast<unsigned int> (indices.size ()),
-        GL_UNSIGNED_INT, 0);
-    glBindVertexArray (0);
-
-    //  set everything back to defaults once configured
-    glActiveTexture (GL_TEXTURE0);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Shader.h"
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -10,6 +11,25 @@ struct Vertex {
     glm::vec2 TexCoords;
 };
 
+// Local-space bounding volumes: an axis-aligned box, and a sphere around the box's center
+struct Bounds {
+    glm::vec3 Min = glm::vec3(0.0f);
+    glm::vec3 Max = glm::vec3(0.0f);
+    glm::vec3 Center = glm::vec3(0.0f);
+    float Radius = 0.0f;
+
+    static Bounds fromVertices(const std::vector<Vertex>& vertices);
+
+    // The box around both boxes, with a sphere on its center that encloses both spheres
+    static Bounds merge(const Bounds& a, const Bounds& b);
+};
+
+// Per-instance attributes for instanced draws (locations 3-6 model matrix, 7 color)
+struct InstanceData {
+    glm::mat4 Model;
+    glm::vec4 Color;
+};
+
 struct Texture {
     unsigned int id;
     std::string type;
@@ -26,6 +46,12 @@ public:
 
     void draw(Shader &shader) const;
 
+    // Draws count instances whose InstanceData starts at firstInstance in instanceBuffer
+    void drawInstanced(Shader &shader, GLuint instanceBuffer, std::size_t firstInstance, GLsizei count) const;
+
+    // Computed from the vertices when the mesh is created
+    const Bounds& getBounds() const { return bounds; }
+
 private:
     GLuint VAO;
     GLuint VBO;
@@ -35,6 +61,10 @@ private:
     std::vector<unsigned int> indices;
     std::vector<Texture> textures;
 
+    Bounds bounds;
+
     void setup();
+
+    void bindTextures(Shader &shader) const;
 };
 
@@ -11,6 +11,13 @@ void Model::draw (Shader& shader) {
     for (unsigned int i = 0; i < mMeshes.size (); i++) mMeshes[i].draw (shader);
 }
 
+std::size_t Model::drawInstanced (Shader& shader, GLuint instanceBuffer,
+    std::size_t firstInstance, GLsizei count) {
+    for (unsigned int i = 0; i < mMeshes.size (); i++)
+        mMeshes[i].drawInstanced (shader, instanceBuffer, firstInstance, count);
+    return mMeshes.size ();
+}
+
 void Model::loadModel (std::string path) {
     Assimp::Importer import;
     const aiScene* scene = import.ReadFile (path,
@@ -26,6 +33,14 @@ void Model::loadModel (std::string path) {
     processNode (scene->mRootNode, scene);
 }
 
+void Model::computeBounds () {
+    if (mMeshes.empty ()) return;
+
+    mBounds = mMeshes[0].getBounds ();
+    for (unsigned int i = 1; i < mMeshes.size (); i++)
+        mBounds = Bounds::merge (mBounds, mMeshes[i].getBounds ());
+}
+
 void Model::processNode (aiNode* node, const aiScene* scene) {
     // process all the node's meshes (if any)
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
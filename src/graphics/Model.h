@@ -11,23 +11,34 @@ public:
     // Constructor for when we want to load a model from a file
     Model(const char *path) {
         loadModel(path);
+        computeBounds();
     }
 
     // Constructor for when we want to create the mesh programatically
     Model(const Mesh& mesh) {
         mMeshes.push_back(mesh);
+        computeBounds();
     }
 
     virtual void draw(Shader &shader);
 
+    // Draws every mesh count times from instanceBuffer; returns the number of draw calls issued
+    std::size_t drawInstanced(Shader &shader, GLuint instanceBuffer, std::size_t firstInstance, GLsizei count);
+
+    // Encloses every mesh, in model space
+    const Bounds& getBounds() const { return mBounds; }
+
 private:
     std::vector<Mesh> mMeshes;
+    Bounds mBounds;
     std::string directory;
 
     std::vector<Texture> textures_loaded;
 
     void loadModel(std::string path);
 
+    void computeBounds();
+
     void processNode(aiNode *node, const aiScene *scene);
 
     Mesh processMesh(aiMesh *mesh, const aiScene *scene);
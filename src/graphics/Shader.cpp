@@ -1,5 +1,7 @@
 #include "Shader.h"
 
+#include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -55,9 +57,61 @@ bool Shader::loadShaders (const std::string& vertPath,
     glDeleteShader (vertShader);
     glDeleteShader (fragShader);
 
+    reflectUniforms ();
+
     return true;
 }
 
+void Shader::reflectUniforms () {
+    uniformLocations.clear ();
+
+    GLint count     = 0;
+    GLint maxLength = 0;
+    glGetProgramiv (programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv (programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name (static_cast<std::size_t> (maxLength) + 1, '\0');
+
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size     = 0;
+        GLenum type    = 0;
+        glGetActiveUniform (programID, static_cast<GLuint> (i), maxLength,
+            &length, &size, &type, &name[0]);
+
+        // Uniform block members have no location
+        GLint location = glGetUniformLocation (programID, name.c_str ());
+        if (location < 0) continue;
+
+        // Arrays are reported as "name[0]" but looked up by their plain name
+        if (length > 3 && name.compare (length - 3, 3, "[0]") == 0) length -= 3;
+        name[length] = '\0';
+
+        uniformLocations.emplace_back (fnv1a_32 (name.c_str (), length), location);
+    }
+
+    std::sort (uniformLocations.begin (), uniformLocations.end ());
+
+    assert (std::adjacent_find (uniformLocations.begin (), uniformLocations.end (),
+        [] (auto const& a, auto const& b) { return a.first == b.first; }) == uniformLocations.end ()
+        && "Two uniform names hash to the same value.");
+}
+
+GLint Shader::getUniformLocation (std::uint32_t nameHash) const {
+    auto it = std::lower_bound (uniformLocations.begin (), uniformLocations.end (),
+        nameHash, [] (auto const& entry, std::uint32_t hash) { return entry.first < hash; });
+
+    return it != uniformLocations.end () && it->first == nameHash ? it->second : -1;
+}
+
+void Shader::bindUniformBlock (const std::string& blockName, GLuint binding) const {
+    GLuint index = glGetUniformBlockIndex (programID, blockName.c_str ());
+
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding (programID, index, binding);
+    }
+}
+
 bool Shader::createShaderFromFile (const std::string& filePath,
     GLuint shaderType,
     GLuint& shaderID) {
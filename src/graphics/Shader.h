@@ -1,6 +1,11 @@
 #pragma once
 
+#include "core/Types.h"
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 
@@ -16,26 +21,46 @@ public:
 
     void use() const;
 
+    // Location of an active uniform by hashed name ("uModel"_hash), -1 if the program has none.
+    // Locations are reflected once at link time, so this never calls into the driver.
+    GLint getUniformLocation(std::uint32_t nameHash) const;
+
+    // Connects a uniform block to a UniformBuffer binding point
+    void bindUniformBlock(const std::string& blockName, GLuint binding) const;
+
     template<typename T>
-    void setUniform(const std::string& name, const T& value)
+    void setUniform(std::uint32_t nameHash, const T& value)
     {
+        GLint location = getUniformLocation(nameHash);
+
         if constexpr (std::is_same_v<T, glm::mat4>)
         {
-            glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+            glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
         }
         else if constexpr (std::is_same_v<T, glm::vec3>)
         {
-            glUniform3fv(glGetUniformLocation(programID, name.c_str()), 1, (GLfloat*)&value[0]);
+            glUniform3fv(location, 1, (GLfloat*)&value[0]);
         }
         else if constexpr (std::is_same_v<T, float>)
         {
-            glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
+            glUniform1f(location, value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            // int, unsigned and bool uniforms, samplers included
+            glUniform1i(location, static_cast<GLint>(value));
         }
-        else if constexpr (std::is_same_v<T, int>)
+        else
         {
-            glUniform1i(glGetUniformLocation(programID, name.c_str()), (GLint)&value);
+            static_assert(!sizeof(T), "Unsupported uniform type.");
         }
+    }
 
+    // Hashes at run time; prefer the _hash overload for literal names
+    template<typename T>
+    void setUniform(const std::string& name, const T& value)
+    {
+        setUniform(fnv1a_32(name.c_str(), name.size()), value);
     }
 
     unsigned int getID() const { return programID; }
@@ -43,6 +68,11 @@ public:
 private:
     GLuint programID = 0;
 
+    // (name hash, location) sorted by hash
+    std::vector<std::pair<std::uint32_t, GLint>> uniformLocations;
+
+    void reflectUniforms();
+
     bool createShaderFromFile(const std::string &filePath,
                               GLuint shaderType,
                               GLuint &shaderID);
@@ -109,9 +109,9 @@ void Skybox::draw (Shader& skyboxShader,
 
     glm::mat4 viewNoTranslation = glm::mat4 (glm::mat3 (view));
 
-    skyboxShader.setUniform ("u_view", viewNoTranslation);
-    skyboxShader.setUniform ("u_projection", projection);
-    skyboxShader.setUniform ("skybox", 0);
+    skyboxShader.setUniform ("uView"_hash, viewNoTranslation);
+    skyboxShader.setUniform ("uProj"_hash, projection);
+    skyboxShader.setUniform ("skybox"_hash, 0);
 
     glBindVertexArray (vao);
     glActiveTexture (GL_TEXTURE0);
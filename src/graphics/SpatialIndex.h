@@ -0,0 +1,130 @@
+#pragma once
+
+#include "DynamicAabbTree.h"
+#include "core/Types.h"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+
+// Entities' world-space boxes in a DynamicAabbTree, so frustum, ray and range queries visit only
+// the part of the scene they touch. A Mediator resource, kept current by SpatialIndexSystem.
+class SpatialIndex
+{
+public:
+    explicit SpatialIndex(EntityIndex maxEntities, float margin = 0.1f)
+        : mTree(margin), mProxies(maxEntities, DynamicAabbTree::NULL_NODE), mEntities(maxEntities, NULL_ENTITY), mBounds(maxEntities)
+    {}
+
+    bool Contains(Entity entity) const
+    {
+        return mEntities[GetEntityIndex(entity)] == entity;
+    }
+
+    // The entity indexed under index, possibly since destroyed, or NULL_ENTITY
+    Entity GetEntity(EntityIndex index) const
+    {
+        return mEntities[index];
+    }
+
+    void Insert(Entity entity, Aabb const& bounds)
+    {
+        assert(!Contains(entity) && "Entity inserted into spatial index more than once.");
+
+        EntityIndex index = GetEntityIndex(entity);
+        mProxies[index] = mTree.CreateProxy(bounds, index);
+        mEntities[index] = entity;
+        mBounds[index] = bounds;
+    }
+
+    // Touches the tree only once the box leaves the margin around where it was last inserted
+    void Update(Entity entity, Aabb const& bounds)
+    {
+        assert(Contains(entity) && "Entity not in spatial index.");
+
+        EntityIndex index = GetEntityIndex(entity);
+        mTree.MoveProxy(mProxies[index], bounds);
+        mBounds[index] = bounds;
+    }
+
+    void Remove(Entity entity)
+    {
+        assert(Contains(entity) && "Entity not in spatial index.");
+
+        EntityIndex index = GetEntityIndex(entity);
+        mTree.DestroyProxy(mProxies[index]);
+        mProxies[index] = DynamicAabbTree::NULL_NODE;
+        mEntities[index] = NULL_ENTITY;
+    }
+
+    std::size_t Size() const { return mTree.Size(); }
+
+    DynamicAabbTree const& GetTree() const { return mTree; }
+
+    // fn(entity) for every entity whose box, grown by the margin, touches the frustum
+    template<typename Fn>
+    void QueryFrustum(Frustum const& frustum, Fn&& fn) const
+    {
+        mTree.QueryFrustum(frustum, [&](std::uint32_t index) { fn(mEntities[index]); });
+    }
+
+    // fn(entity) for every entity whose box comes within radius of center
+    template<typename Fn>
+    void QueryRange(float const* center, float radius, Fn&& fn) const
+    {
+        Aabb range;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            range.min[axis] = center[axis] - radius;
+            range.max[axis] = center[axis] + radius;
+        }
+
+        mTree.QueryAabb(range, [&](std::uint32_t index) {
+            if (mBounds[index].DistanceSquared(center) <= radius * radius)
+            {
+                fn(mEntities[index]);
+            }
+        });
+    }
+
+    // The entity whose box the ray origin + t * direction enters first within maxDistance, or
+    // NULL_ENTITY; distance, if given, receives the entry distance
+    Entity RayPick(float const* origin, float const* direction, float maxDistance, float* distance = nullptr) const
+    {
+        float inverseDirection[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            inverseDirection[axis] = 1.0f / direction[axis];
+        }
+
+        Entity closest = NULL_ENTITY;
+
+        // Each confirmed hit clips the ray, so farther boxes are skipped from then on
+        mTree.RayCast(origin, direction, maxDistance, [&](std::uint32_t index, float) {
+            float entry = mBounds[index].RayEntry(origin, inverseDirection, maxDistance);
+
+            if (entry >= 0.0f)
+            {
+                closest = mEntities[index];
+                maxDistance = entry;
+            }
+
+            return maxDistance;
+        });
+
+        if (distance && closest != NULL_ENTITY)
+        {
+            *distance = maxDistance;
+        }
+
+        return closest;
+    }
+
+private:
+    DynamicAabbTree mTree;
+
+    // Indexed by entity index
+    std::vector<std::int32_t> mProxies;
+    std::vector<Entity> mEntities;
+    std::vector<Aabb> mBounds;
+};
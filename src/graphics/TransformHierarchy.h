@@ -0,0 +1,229 @@
+#pragma once
+
+#include "TransformMath.h"
+#include "core/JobSystem.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+// Parent-relative matrices laid out breadth first: roots first, then every node one level down,
+// and so on, with siblings next to each other. A parent always sits in an earlier level than its
+// children, so world matrices propagate in one forward pass over contiguous arrays, and the nodes of
+// a level never depend on each other, so a wide level can be split across threads.
+//
+// Only dirty nodes and the nodes below them are recomputed; a clean subtree costs one flag test per
+// node.
+class TransformHierarchy
+{
+public:
+    static constexpr std::uint32_t NO_PARENT = ~std::uint32_t{0};
+
+    // 16 column-major floats, glm layout
+    struct alignas(16) Matrix
+    {
+        float m[16];
+    };
+
+    // Lays out the nodes: parents[i] is node i's parent, another node index, or NO_PARENT for a root.
+    // Roots keep their input order and each parent's children keep theirs. Every local matrix is
+    // reset to identity and every node starts dirty.
+    void Build(std::span<std::uint32_t const> parents)
+    {
+        std::size_t const count = parents.size();
+
+        // Children of each node, grouped by parent
+        mChildBegin.assign(count + 1, 0);
+        for (std::uint32_t parent : parents)
+        {
+            if (parent != NO_PARENT)
+            {
+                assert(parent < count && "Parent out of range.");
+                ++mChildBegin[parent + 1];
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            mChildBegin[i + 1] += mChildBegin[i];
+        }
+
+        mChildren.resize(mChildBegin[count]);
+        mChildFill.assign(mChildBegin.begin(), mChildBegin.end() - 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (parents[i] != NO_PARENT)
+            {
+                mChildren[mChildFill[parents[i]]++] = static_cast<std::uint32_t>(i);
+            }
+        }
+
+        // Breadth first: the roots, then the children of each level in the order of their parents
+        mNodes.clear();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (parents[i] == NO_PARENT)
+            {
+                mNodes.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+
+        mLevels.assign(1, 0);
+        while (mLevels.back() < mNodes.size())
+        {
+            std::size_t const levelEnd = mNodes.size();
+
+            for (std::size_t slot = mLevels.back(); slot < levelEnd; ++slot)
+            {
+                std::uint32_t node = mNodes[slot];
+                mNodes.insert(mNodes.end(), mChildren.begin() + mChildBegin[node], mChildren.begin() + mChildBegin[node + 1]);
+            }
+
+            mLevels.push_back(levelEnd);
+        }
+
+        assert(mNodes.size() == count && "Parent cycle: some nodes never reach a root.");
+
+        mSlots.resize(count);
+        for (std::size_t slot = 0; slot < count; ++slot)
+        {
+            mSlots[mNodes[slot]] = static_cast<std::uint32_t>(slot);
+        }
+
+        mParents.resize(count);
+        for (std::size_t slot = 0; slot < count; ++slot)
+        {
+            std::uint32_t parent = parents[mNodes[slot]];
+            mParents[slot] = parent == NO_PARENT ? NO_PARENT : mSlots[parent];
+        }
+
+        Matrix const identity{{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}};
+        mLocal.assign(count, identity);
+        mWorld.assign(count, identity);
+        mDirty.assign(count, 1);
+    }
+
+    std::size_t Size() const { return mNodes.size(); }
+
+    std::size_t LevelCount() const { return mLevels.size() - 1; }
+
+    std::uint32_t Slot(std::uint32_t node) const { return mSlots[node]; }
+
+    std::uint32_t Node(std::uint32_t slot) const { return mNodes[slot]; }
+
+    // The parent's slot, or NO_PARENT for a root
+    std::uint32_t Parent(std::uint32_t slot) const { return mParents[slot]; }
+
+    // Parent-relative matrix; a root's local matrix is its world matrix. Mark the slot dirty after
+    // changing it.
+    float* Local(std::uint32_t slot) { return mLocal[slot].m; }
+
+    float const* World(std::uint32_t slot) const { return mWorld[slot].m; }
+
+    void MarkDirty(std::uint32_t slot) { mDirty[slot] = 1; }
+
+    // After Propagate: true for every slot whose world matrix was recomputed
+    bool IsDirty(std::uint32_t slot) const { return mDirty[slot] != 0; }
+
+    // Recomputes the world matrix of every dirty node and of every node below one, level by level.
+    // Levels of at least two grains are split across jobSystem when one is given. The dirty flags
+    // stay set, for the caller to read back, until ClearDirty.
+    void Propagate(JobSystem* jobSystem = nullptr, std::size_t grainSize = 4096)
+    {
+        for (std::size_t level = 0; level < LevelCount(); ++level)
+        {
+            std::size_t const begin = mLevels[level];
+            std::size_t const end = mLevels[level + 1];
+
+            if (!jobSystem || end - begin < 2 * grainSize)
+            {
+                PropagateRange(begin, end);
+                continue;
+            }
+
+            ParallelContext context{this, begin, end, grainSize};
+            JobCounter counter;
+
+            for (std::size_t chunk = 0; chunk * grainSize < end - begin; ++chunk)
+            {
+                jobSystem->Submit(Job{
+                    .function = &RunChunk,
+                    .context = &context,
+                    .index = chunk,
+                    .counter = &counter
+                });
+            }
+
+            // A level must be complete before the next one reads it
+            jobSystem->Wait(counter);
+        }
+    }
+
+    void ClearDirty()
+    {
+        std::fill(mDirty.begin(), mDirty.end(), std::uint8_t{0});
+    }
+
+private:
+    struct ParallelContext
+    {
+        TransformHierarchy* hierarchy{};
+        std::size_t begin{};
+        std::size_t end{};
+        std::size_t grainSize{};
+    };
+
+    static void RunChunk(void* context, std::size_t index)
+    {
+        auto const& parallel = *static_cast<ParallelContext*>(context);
+        std::size_t begin = parallel.begin + index * parallel.grainSize;
+
+        parallel.hierarchy->PropagateRange(begin, std::min(parallel.end, begin + parallel.grainSize));
+    }
+
+    // Parents are in an earlier level, so their flags and world matrices are final here
+    void PropagateRange(std::size_t begin, std::size_t end)
+    {
+        for (std::size_t slot = begin; slot < end; ++slot)
+        {
+            std::uint32_t parent = mParents[slot];
+
+            if (parent == NO_PARENT)
+            {
+                if (mDirty[slot])
+                {
+                    mWorld[slot] = mLocal[slot];
+                }
+                continue;
+            }
+
+            mDirty[slot] |= mDirty[parent];
+
+            if (mDirty[slot])
+            {
+                TransformMath::Multiply(mWorld[parent].m, mLocal[slot].m, mWorld[slot].m);
+            }
+        }
+    }
+
+    // Indexed by slot
+    std::vector<std::uint32_t> mNodes;
+    std::vector<std::uint32_t> mParents;
+    std::vector<Matrix> mLocal;
+    std::vector<Matrix> mWorld;
+    std::vector<std::uint8_t> mDirty;
+
+    // Indexed by node
+    std::vector<std::uint32_t> mSlots;
+
+    // Slot where each level begins, then the end of the last level
+    std::vector<std::size_t> mLevels;
+
+    // Build scratch
+    std::vector<std::size_t> mChildBegin;
+    std::vector<std::size_t> mChildFill;
+    std::vector<std::uint32_t> mChildren;
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+
+// Transforms split into one array per field so the world-matrix pass can load a register's worth of
+// entities per field. Only yaw is kept: world matrices are translate * scale * rotateY.
+struct TransformSoA
+{
+    std::vector<float> positionX{};
+    std::vector<float> positionY{};
+    std::vector<float> positionZ{};
+    std::vector<float> rotationY{};
+    std::vector<float> scaleX{};
+    std::vector<float> scaleY{};
+    std::vector<float> scaleZ{};
+
+    std::size_t Size() const { return positionX.size(); }
+
+    void Clear()
+    {
+        for (auto* field : {&positionX, &positionY, &positionZ, &rotationY, &scaleX, &scaleY, &scaleZ})
+        {
+            field->clear();
+        }
+    }
+
+    void Reserve(std::size_t capacity)
+    {
+        for (auto* field : {&positionX, &positionY, &positionZ, &rotationY, &scaleX, &scaleY, &scaleZ})
+        {
+            field->reserve(capacity);
+        }
+    }
+
+    void Push(float px, float py, float pz, float yaw, float sx, float sy, float sz)
+    {
+        positionX.push_back(px);
+        positionY.push_back(py);
+        positionZ.push_back(pz);
+        rotationY.push_back(yaw);
+        scaleX.push_back(sx);
+        scaleY.push_back(sy);
+        scaleZ.push_back(sz);
+    }
+};
+
+
+namespace TransformMath {
+
+// Writes one world matrix for a single transform, 16 column-major floats (glm layout)
+inline void WorldMatrix(float px, float py, float pz, float yaw, float sx, float sy, float sz, float* out)
+{
+    float c = std::cos(yaw);
+    float s = std::sin(yaw);
+
+    float const matrix[16] = {
+        sx * c, 0.0f, sz * s, 0.0f,
+        0.0f, sy, 0.0f, 0.0f,
+        -sx * s, 0.0f, sz * c, 0.0f,
+        px, py, pz, 1.0f
+    };
+
+    std::memcpy(out, matrix, sizeof(matrix));
+}
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+
+// out = a * b for column-major 4x4 matrices: each column of out is a's columns weighted by the
+// matching column of b. out may alias a or b.
+inline void Multiply(float const* a, float const* b, float* out)
+{
+    __m128 const a0 = _mm_loadu_ps(a);
+    __m128 const a1 = _mm_loadu_ps(a + 4);
+    __m128 const a2 = _mm_loadu_ps(a + 8);
+    __m128 const a3 = _mm_loadu_ps(a + 12);
+
+    for (int column = 0; column < 4; ++column)
+    {
+        float const* weights = b + 4 * column;
+
+        __m128 result = _mm_mul_ps(a0, _mm_set1_ps(weights[0]));
+        result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(weights[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(weights[2])));
+        result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(weights[3])));
+
+        _mm_storeu_ps(out + 4 * column, result);
+    }
+}
+
+namespace Detail {
+
+// Four matrices from the lanes of the eight non-constant entries; each column is a 4x4 transpose
+inline void StoreMatrices(float* out, __m128 m00, __m128 m02, __m128 m11, __m128 m20, __m128 m22, __m128 px, __m128 py, __m128 pz)
+{
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1.0f);
+
+    __m128 column0[4] = {m00, zero, m02, zero};
+    __m128 column1[4] = {zero, m11, zero, zero};
+    __m128 column2[4] = {m20, zero, m22, zero};
+    __m128 column3[4] = {px, py, pz, one};
+
+    _MM_TRANSPOSE4_PS(column0[0], column0[1], column0[2], column0[3]);
+    _MM_TRANSPOSE4_PS(column1[0], column1[1], column1[2], column1[3]);
+    _MM_TRANSPOSE4_PS(column2[0], column2[1], column2[2], column2[3]);
+    _MM_TRANSPOSE4_PS(column3[0], column3[1], column3[2], column3[3]);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        _mm_storeu_ps(out + 16 * i + 0, column0[i]);
+        _mm_storeu_ps(out + 16 * i + 4, column1[i]);
+        _mm_storeu_ps(out + 16 * i + 8, column2[i]);
+        _mm_storeu_ps(out + 16 * i + 12, column3[i]);
+    }
+}
+
+#if defined(__AVX2__)
+
+constexpr std::size_t LANES = 8;
+
+using Floats = __m256;
+using Ints = __m256i;
+
+inline Floats Load(float const* p) { return _mm256_loadu_ps(p); }
+inline Floats Set(float value) { return _mm256_set1_ps(value); }
+inline Floats Add(Floats a, Floats b) { return _mm256_add_ps(a, b); }
+inline Floats Sub(Floats a, Floats b) { return _mm256_sub_ps(a, b); }
+inline Floats Mul(Floats a, Floats b) { return _mm256_mul_ps(a, b); }
+inline Floats Min(Floats a, Floats b) { return _mm256_min_ps(a, b); }
+inline int SignMask(Floats a) { return _mm256_movemask_ps(a); }
+inline Floats Xor(Floats a, Floats b) { return _mm256_xor_ps(a, b); }
+inline Floats Select(Floats mask, Floats a, Floats b) { return _mm256_blendv_ps(b, a, mask); }
+inline Ints Round(Floats a) { return _mm256_cvtps_epi32(a); }
+inline Floats ToFloats(Ints a) { return _mm256_cvtepi32_ps(a); }
+inline Ints SetInts(int value) { return _mm256_set1_epi32(value); }
+inline Ints AddInts(Ints a, Ints b) { return _mm256_add_epi32(a, b); }
+inline Ints AndInts(Ints a, Ints b) { return _mm256_and_si256(a, b); }
+inline Floats EqualInts(Ints a, Ints b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+inline Floats SignBit(Ints bit1) { return _mm256_castsi256_ps(_mm256_slli_epi32(bit1, 30)); }
+
+inline void Store(float* out, Floats m00, Floats m02, Floats m11, Floats m20, Floats m22, Floats px, Floats py, Floats pz)
+{
+    StoreMatrices(out,
+        _mm256_castps256_ps128(m00), _mm256_castps256_ps128(m02), _mm256_castps256_ps128(m11),
+        _mm256_castps256_ps128(m20), _mm256_castps256_ps128(m22),
+        _mm256_castps256_ps128(px), _mm256_castps256_ps128(py), _mm256_castps256_ps128(pz));
+    StoreMatrices(out + 64,
+        _mm256_extractf128_ps(m00, 1), _mm256_extractf128_ps(m02, 1), _mm256_extractf128_ps(m11, 1),
+        _mm256_extractf128_ps(m20, 1), _mm256_extractf128_ps(m22, 1),
+        _mm256_extractf128_ps(px, 1), _mm256_extractf128_ps(py, 1), _mm256_extractf128_ps(pz, 1));
+}
+
+#else
+
+constexpr std::size_t LANES = 4;
+
+using Floats = __m128;
+using Ints = __m128i;
+
+inline Floats Load(float const* p) { return _mm_loadu_ps(p); }
+inline Floats Set(float value) { return _mm_set1_ps(value); }
+inline Floats Add(Floats a, Floats b) { return _mm_add_ps(a, b); }
+inline Floats Sub(Floats a, Floats b) { return _mm_sub_ps(a, b); }
+inline Floats Mul(Floats a, Floats b) { return _mm_mul_ps(a, b); }
+inline Floats Min(Floats a, Floats b) { return _mm_min_ps(a, b); }
+inline int SignMask(Floats a) { return _mm_movemask_ps(a); }
+inline Floats Xor(Floats a, Floats b) { return _mm_xor_ps(a, b); }
+inline Floats Select(Floats mask, Floats a, Floats b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline Ints Round(Floats a) { return _mm_cvtps_epi32(a); }
+inline Floats ToFloats(Ints a) { return _mm_cvtepi32_ps(a); }
+inline Ints SetInts(int value) { return _mm_set1_epi32(value); }
+inline Ints AddInts(Ints a, Ints b) { return _mm_add_epi32(a, b); }
+inline Ints AndInts(Ints a, Ints b) { return _mm_and_si128(a, b); }
+inline Floats EqualInts(Ints a, Ints b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+inline Floats SignBit(Ints bit1) { return _mm_castsi128_ps(_mm_slli_epi32(bit1, 30)); }
+
+inline void Store(float* out, Floats m00, Floats m02, Floats m11, Floats m20, Floats m22, Floats px, Floats py, Floats pz)
+{
+    StoreMatrices(out, m00, m02, m11, m20, m22, px, py, pz);
+}
+
+#endif
+
+// Sine and cosine of every lane, accurate to a few ulp for angles within a few thousand radians.
+// The angle is reduced to [-pi/4, pi/4] around the nearest multiple of pi/2 (pi/2 split in three so
+// the products are exact), both minimax polynomials are evaluated, and the quadrant picks and signs
+// the results.
+inline void SinCos(Floats x, Floats& sine, Floats& cosine)
+{
+    Ints quadrant = Round(Mul(x, Set(0.636619772f)));
+    Floats q = ToFloats(quadrant);
+
+    Floats r = Sub(x, Mul(q, Set(1.5703125f)));
+    r = Sub(r, Mul(q, Set(4.837512969970703125e-4f)));
+    r = Sub(r, Mul(q, Set(7.54978995489188216e-8f)));
+    Floats r2 = Mul(r, r);
+
+    Floats s = Add(Mul(Set(-1.9515295891e-4f), r2), Set(8.3321608736e-3f));
+    s = Add(Mul(s, r2), Set(-1.6666654611e-1f));
+    s = Add(Mul(Mul(s, r2), r), r);
+
+    Floats c = Add(Mul(Set(2.443315711809948e-5f), r2), Set(-1.388731625493765e-3f));
+    c = Add(Mul(c, r2), Set(4.166664568298827e-2f));
+    c = Add(Sub(Mul(Mul(c, r2), r2), Mul(Set(0.5f), r2)), Set(1.0f));
+
+    // Odd quadrants swap the two; sine is negated in quadrants 2 and 3, cosine in 1 and 2
+    Floats swap = EqualInts(AndInts(quadrant, SetInts(1)), SetInts(1));
+    sine = Xor(Select(swap, c, s), SignBit(AndInts(quadrant, SetInts(2))));
+    cosine = Xor(Select(swap, s, c), SignBit(AndInts(AddInts(quadrant, SetInts(1)), SetInts(2))));
+}
+
+inline void WorldMatrices(TransformSoA const& transforms, std::size_t first, float* out)
+{
+    Floats sine, cosine;
+    SinCos(Load(&transforms.rotationY[first]), sine, cosine);
+
+    Floats sx = Load(&transforms.scaleX[first]);
+    Floats sz = Load(&transforms.scaleZ[first]);
+
+    Store(out,
+        Mul(sx, cosine), Mul(sz, sine), Load(&transforms.scaleY[first]),
+        Xor(Mul(sx, sine), Set(-0.0f)), Mul(sz, cosine),
+        Load(&transforms.positionX[first]), Load(&transforms.positionY[first]), Load(&transforms.positionZ[first]));
+}
+
+}
+
+// Entities per SIMD step
+constexpr std::size_t LANES = Detail::LANES;
+
+// World matrices for every transform, 16 column-major floats each, LANES transforms per step
+// (8 with AVX2, 4 with SSE2). The last partial step goes through the scalar path.
+inline void WorldMatrices(TransformSoA const& transforms, float* out)
+{
+    std::size_t const count = transforms.Size();
+    std::size_t const whole = count - count % LANES;
+
+    for (std::size_t i = 0; i < whole; i += LANES)
+    {
+        Detail::WorldMatrices(transforms, i, out + 16 * i);
+    }
+
+    for (std::size_t i = whole; i < count; ++i)
+    {
+        WorldMatrix(
+            transforms.positionX[i], transforms.positionY[i], transforms.positionZ[i], transforms.rotationY[i],
+            transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i], out + 16 * i);
+    }
+}
+
+#else
+
+// out = a * b for column-major 4x4 matrices. out may alias a or b.
+inline void Multiply(float const* a, float const* b, float* out)
+{
+    float result[16];
+
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            result[4 * column + row] =
+                a[row] * b[4 * column] + a[4 + row] * b[4 * column + 1] +
+                a[8 + row] * b[4 * column + 2] + a[12 + row] * b[4 * column + 3];
+        }
+    }
+
+    std::memcpy(out, result, sizeof(result));
+}
+
+constexpr std::size_t LANES = 1;
+
+inline void WorldMatrices(TransformSoA const& transforms, float* out)
+{
+    for (std::size_t i = 0; i < transforms.Size(); ++i)
+    {
+        WorldMatrix(
+            transforms.positionX[i], transforms.positionY[i], transforms.positionZ[i], transforms.rotationY[i],
+            transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i], out + 16 * i);
+    }
+}
+
+#endif
+
+}
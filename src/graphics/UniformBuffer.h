@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/glad.h>
+
+
+// Backing buffer for a uniform block, attached to one binding point. T mirrors the block's std140
+// layout: vec3s are stored as vec4s and the struct is padded to a multiple of 16 bytes.
+template<typename T>
+class UniformBuffer {
+public:
+    explicit UniformBuffer(GLuint binding) : binding(binding) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    ~UniformBuffer() {
+        glDeleteBuffers(1, &buffer);
+    }
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // One upload serves every shader whose block is bound to this binding point
+    void upload(const T& data) const {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    GLuint getBinding() const { return binding; }
+
+private:
+    GLuint buffer = 0;
+    GLuint binding;
+};
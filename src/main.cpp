@@ -2,40 +2,96 @@
 #include "components/Camera.h"
 #include "systems/RenderSystem.h"
 #include "systems/CameraControlSystem.h"
+#include "components/Parent.h"
 #include "components/Renderable.h"
 #include "components/Transform.h"
+#include "components/WorldMatrix.h"
 #include "core/Mediator.h"
 #include "graphics/PrimitiveMeshes.h"
+#include "graphics/SpatialIndex.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <random>
 
 #include "components/Cubemap.h"
+#include "systems/HierarchySystem.h"
 #include "systems/SkyboxRenderSystem.h"
+#include "systems/SpatialIndexSystem.h"
+#include "systems/TransformSystem.h"
 
 Mediator gMediator;
 
 bool quit = false;
 
-void QuitHandler(Event& event)
+void QuitHandler(Events::Window::Quit const& event)
 {
     quit = true;
 }
 
-int main() {
+// --frames N: render N frames in a hidden window, print the render stats and exit
+// --instances N: add N spheres sharing one model
+int main(int argc, char* argv[]) {
+    long frameLimit = 0;
+    long instanceCount = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0)
+        {
+            frameLimit = std::strtol(argv[i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--instances") == 0)
+        {
+            instanceCount = std::strtol(argv[i + 1], nullptr, 10);
+        }
+    }
+
     gMediator.Init();
 
     WindowManager windowManager;
-    windowManager.Init("Hello World", 1920, 1080, 0, 0);
+    windowManager.Init("Hello World", 1920, 1080, 0, 0, frameLimit <= 0);
 
-    gMediator.AddEventListener(FUNCTION_LISTENER(Events::Window::QUIT, QuitHandler));
+    gMediator.AddEventListener<Events::Window::Quit, &QuitHandler>();
+
+    // Input arrives from GLFW callbacks; buffer it and deliver it once per frame, coalesced
+    gMediator.SetEventQueued<Events::Window::KeyDown>();
+    gMediator.SetEventQueued<Events::Window::MouseMove>();
+    gMediator.SetEventQueued<Events::Window::Resized>();
 
     gMediator.RegisterComponent<Camera>();
     gMediator.RegisterComponent<Cubemap>();
+    gMediator.RegisterComponent<Parent>();
     gMediator.RegisterComponent<Renderable>();
     gMediator.RegisterComponent<Transform>();
+    gMediator.RegisterComponent<WorldMatrix>();
+
+    // Let the transform, hierarchy and render systems skip what did not change since their last update
+    gMediator.TrackChanges<Parent>();
+    gMediator.TrackChanges<Renderable>();
+    gMediator.TrackChanges<Transform>();
+    gMediator.TrackChanges<WorldMatrix>();
+
+
+
+    // Registration order is the order systems that touch the same data run in: skybox draws first
+    auto skyboxRenderSystem = gMediator.RegisterSystem<SkyboxRenderSystem>();
+    {
+        Signature signature;
+        signature.set(gMediator.GetComponentType<Cubemap>());
+        gMediator.SetSystemSignature<SkyboxRenderSystem>(signature);
+
+        Signature reads;
+        reads.set(gMediator.GetComponentType<Camera>());
+        reads.set(gMediator.GetComponentType<Cubemap>());
+        reads.set(gMediator.GetComponentType<Transform>());
+        gMediator.SetSystemAccess<SkyboxRenderSystem>(SystemAccess::Declare(reads, {}, ThreadAffinity::MainThread));
+    }
 
+    skyboxRenderSystem->Init();
 
 
     auto cameraControlSystem = gMediator.RegisterSystem<CameraControlSystem>();
@@ -44,33 +100,94 @@ int main() {
         signature.set(gMediator.GetComponentType<Camera>());
         signature.set(gMediator.GetComponentType<Transform>());
         gMediator.SetSystemSignature<CameraControlSystem>(signature);
+
+        Signature reads;
+        reads.set(gMediator.GetComponentType<Camera>());
+        Signature writes;
+        writes.set(gMediator.GetComponentType<Transform>());
+        gMediator.SetSystemAccess<CameraControlSystem>(SystemAccess::Declare(reads, writes));
     }
 
     cameraControlSystem->Init();
 
 
-    auto renderSystem = gMediator.RegisterSystem<RenderSystem>();
+    auto transformSystem = gMediator.RegisterSystem<TransformSystem>();
+    {
+        Signature signature;
+        signature.set(gMediator.GetComponentType<Transform>());
+        signature.set(gMediator.GetComponentType<WorldMatrix>());
+        gMediator.SetSystemSignature<TransformSystem>(signature);
+
+        Signature reads;
+        reads.set(gMediator.GetComponentType<Transform>());
+        Signature writes;
+        writes.set(gMediator.GetComponentType<WorldMatrix>());
+        gMediator.SetSystemAccess<TransformSystem>(SystemAccess::Declare(reads, writes));
+    }
+
+    transformSystem->Init();
+
+
+    auto hierarchySystem = gMediator.RegisterSystem<HierarchySystem>();
+    {
+        Signature signature;
+        signature.set(gMediator.GetComponentType<Parent>());
+        signature.set(gMediator.GetComponentType<Transform>());
+        signature.set(gMediator.GetComponentType<WorldMatrix>());
+        gMediator.SetSystemSignature<HierarchySystem>(signature);
+
+        Signature reads;
+        reads.set(gMediator.GetComponentType<Parent>());
+        reads.set(gMediator.GetComponentType<Transform>());
+        Signature writes;
+        writes.set(gMediator.GetComponentType<WorldMatrix>());
+        gMediator.SetSystemAccess<HierarchySystem>(SystemAccess::Declare(reads, writes));
+    }
+
+    hierarchySystem->Init();
+
+
+    // Adds the SpatialIndex resource RenderSystem culls with
+    auto spatialIndexSystem = gMediator.RegisterSystem<SpatialIndexSystem>();
     {
         Signature signature;
         signature.set(gMediator.GetComponentType<Renderable>());
         signature.set(gMediator.GetComponentType<Transform>());
-        gMediator.SetSystemSignature<RenderSystem>(signature);
+        signature.set(gMediator.GetComponentType<WorldMatrix>());
+        gMediator.SetSystemSignature<SpatialIndexSystem>(signature);
+
+        Signature reads;
+        reads.set(gMediator.GetComponentType<Renderable>());
+        reads.set(gMediator.GetComponentType<WorldMatrix>());
+        Signature resourceWrites;
+        resourceWrites.set(gMediator.GetResourceType<SpatialIndex>());
+        gMediator.SetSystemAccess<SpatialIndexSystem>(SystemAccess::Declare(reads, {}).WithResources({}, resourceWrites));
     }
 
-    renderSystem->Init();
+    spatialIndexSystem->Init();
 
-    auto skyboxRenderSystem = gMediator.RegisterSystem<SkyboxRenderSystem>();
+
+    auto renderSystem = gMediator.RegisterSystem<RenderSystem>();
     {
         Signature signature;
-        signature.set(gMediator.GetComponentType<Cubemap>());
-        gMediator.SetSystemSignature<SkyboxRenderSystem>(signature);
+        signature.set(gMediator.GetComponentType<Renderable>());
+        signature.set(gMediator.GetComponentType<Transform>());
+        signature.set(gMediator.GetComponentType<WorldMatrix>());
+        gMediator.SetSystemSignature<RenderSystem>(signature);
+
+        Signature reads = signature;
+        reads.set(gMediator.GetComponentType<Camera>());
+        Signature resourceReads;
+        resourceReads.set(gMediator.GetResourceType<SpatialIndex>());
+        gMediator.SetSystemAccess<RenderSystem>(
+            SystemAccess::Declare(reads, {}, ThreadAffinity::MainThread).WithResources(resourceReads, {}));
     }
 
+    renderSystem->Init();
 
-    skyboxRenderSystem->Init();
 
 
-    std::vector<Entity> entities(MAX_ENTITIES - 1);
+    std::vector<Entity> entities;
 
     std::default_random_engine generator;
     std::uniform_real_distribution<float> randPosition(-10.0f, 10.0f);
@@ -82,17 +199,16 @@ int main() {
     float scale = randScale(generator);
 
     // init all entities empty
-    for (auto& entity : entities)
-    {
-        entity = gMediator.CreateEntity();
-    }
+    gMediator.CreateEntities(gMediator.GetMaxEntities() - 1, entities);
 
 
     // Sphere
+    auto sphereModel = std::make_shared<Model>(createSphereMesh());
+
     gMediator.AddComponent<Renderable>(
         entities[0],
         Renderable{
-            .model = std::make_shared<Model>(createSphereMesh()),
+            .model = sphereModel,
             .color = glm::vec3(0.9f, 0.15f, 0.1f)
         });
 
@@ -120,7 +236,7 @@ int main() {
               .scale = glm::vec3(5.0f)
           });
 
-    // Lamp
+    // Lamp, standing on the table: its Transform is relative to the table's
     gMediator.AddComponent<Renderable>(
         entities[2],
         Renderable{
@@ -131,11 +247,13 @@ int main() {
     gMediator.AddComponent<Transform>(
           entities[2],
           Transform{
-              .position = glm::vec3(4.0f, 6.0f, 0.0f),
+              .position = glm::vec3(0.8f, 1.2f, 0.0f),
               .rotation = glm::vec3(0.0f),
-              .scale = glm::vec3(1.0f)
+              .scale = glm::vec3(0.2f)
           });
 
+    gMediator.AddComponent<Parent>(entities[2], Parent{.entity = entities[1]});
+
 
     // Skybox
     {
@@ -187,25 +305,71 @@ int main() {
               .scale = glm::vec3(0.06f)
           });
 
+    // Extra spheres: one instanced draw however many there are
+    {
+        std::size_t const first = 6;
+        std::size_t const count = std::min<std::size_t>(std::max(instanceCount, 0L), entities.size() - first);
+
+        for (std::size_t i = first; i < first + count; ++i)
+        {
+            gMediator.AddComponent<Renderable>(
+                entities[i],
+                Renderable{
+                    .model = sphereModel,
+                    .color = glm::vec3(randColor(generator), randColor(generator), randColor(generator))
+                });
+
+            gMediator.AddComponent<Transform>(
+                entities[i],
+                Transform{
+                    .position = glm::vec3(randPosition(generator), randPosition(generator) + 10.0f, randPosition(generator)),
+                    .rotation = glm::vec3(0.0f),
+                    .scale = glm::vec3(0.2f)
+                });
+        }
+    }
+
+    // Every rendered entity gets a WorldMatrix for TransformSystem to fill in
+    {
+        std::vector<Entity> rendered;
+        gMediator.Each<Renderable const>([&](Entity entity, Renderable const&) { rendered.push_back(entity); });
+
+        std::vector<WorldMatrix> worldMatrices(rendered.size());
+        gMediator.AddComponents<WorldMatrix>(rendered, worldMatrices);
+    }
+
+    // Lay out render data in the order RenderSystem visits it
+    gMediator.SortComponents<Transform>(*renderSystem);
+    gMediator.SortComponents<Renderable>(*renderSystem);
+    gMediator.SortComponents<WorldMatrix>(*renderSystem);
+
     // Delta time
     float dt = 0.0f;
+    long frame = 0;
 
-    while(!quit) {
+    while(!quit && (frameLimit <= 0 || frame < frameLimit)) {
         auto startTime = std::chrono::high_resolution_clock::now();
 
         windowManager.Update();
 
         windowManager.ProcessEvents();
 
-        skyboxRenderSystem->Update(dt);
-
-        cameraControlSystem->Update(dt);
+        gMediator.DispatchEvents();
 
-        renderSystem->Update(dt);
+        gMediator.UpdateSystems(dt);
 
         auto stopTime = std::chrono::high_resolution_clock::now();
 
         dt = std::chrono::duration<float, std::chrono::seconds::period>(stopTime - startTime).count();
+        ++frame;
+    }
+
+    if (frameLimit > 0)
+    {
+        RenderStats const& stats = renderSystem->GetStats();
+        std::cout << frame << " frames, last frame: " << stats.drawCalls << " draw calls, "
+                  << stats.batches << " models, " << stats.instances << " instances, "
+                  << stats.visibleInstances << " visible, " << stats.uploadedInstances << " uploaded\n";
     }
 
     windowManager.Shutdown();
@@ -2,6 +2,7 @@
 
 #include <iostream>
 
+#include "Components/Camera.h"
 #include "Components/Transform.h"
 #include "Core/Mediator.h"
 
@@ -11,15 +12,14 @@ extern Mediator gMediator;
 
 void CameraControlSystem::Init()
 {
-    gMediator.AddEventListener(METHOD_LISTENER(Events::Window::KEYDOWN, CameraControlSystem::KeyboardInputListener));
-    gMediator.AddEventListener(METHOD_LISTENER(Events::Window::MOUSEMOVE, CameraControlSystem::MouseInputListener));
+    gMediator.AddEventListener<Events::Window::KeyDown, &CameraControlSystem::KeyboardInputListener>(this);
+    gMediator.AddEventListener<Events::Window::MouseMove, &CameraControlSystem::MouseInputListener>(this);
 }
 
 void CameraControlSystem::Update(float dt)
 {
-    for (auto& entity : mEntities)
+    gMediator.Each<Transform, Camera const>([&](Transform& transform, Camera const&)
     {
-        auto& transform = gMediator.GetComponent<Transform>(entity);
         // Precompute cameras right vector
         glm::vec3 right = glm::normalize(glm::cross(transform.forward, transform.up));
 
@@ -66,17 +66,17 @@ void CameraControlSystem::Update(float dt)
         {
             transform.position += (dt * cameraSpeed) * right;
         }
-    }
+    });
 
 }
 
-void CameraControlSystem::KeyboardInputListener(Event& event)
+void CameraControlSystem::KeyboardInputListener(Events::Window::KeyDown const& event)
 {
-    mButtons = event.GetParam<std::bitset<8>>(Events::Window::Input::KEYS_DOWN);
+    mButtons = event.buttons;
 }
 
-void CameraControlSystem::MouseInputListener(Event& event)
+void CameraControlSystem::MouseInputListener(Events::Window::MouseMove const& event)
 {
-    mPitch += event.GetParam<double>(Events::Window::Input::MOUSE_YOFFSET) * mouseSensitivity;
-    mYaw += event.GetParam<double>(Events::Window::Input::MOUSE_XOFFSET) * mouseSensitivity;
+    mPitch += event.yOffset * mouseSensitivity;
+    mYaw += event.xOffset * mouseSensitivity;
 }
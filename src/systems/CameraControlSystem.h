@@ -1,9 +1,9 @@
 #pragma once
 
+#include "core/Event.h"
 #include "core/System.h"
 
-
-class Event;
+#include <bitset>
 
 
 class CameraControlSystem : public System
@@ -22,6 +22,6 @@ private:
     float cameraSpeed = 40.0f;
 
     // Listeners
-    void KeyboardInputListener(Event& event);
-    void MouseInputListener(Event& event);
+    void KeyboardInputListener(Events::Window::KeyDown const& event);
+    void MouseInputListener(Events::Window::MouseMove const& event);
 };
@@ -0,0 +1,152 @@
+#include "HierarchySystem.h"
+
+#include "components/Parent.h"
+#include "components/Transform.h"
+#include "components/WorldMatrix.h"
+#include "core/Mediator.h"
+#include "graphics/TransformMath.h"
+#include <cassert>
+#include <cstring>
+
+
+extern Mediator gMediator;
+
+
+void HierarchySystem::Init()
+{
+    mMemberSlots.assign(gMediator.GetMaxEntities(), NO_SLOT);
+    mNodeOf.assign(gMediator.GetMaxEntities(), NO_SLOT);
+}
+
+void HierarchySystem::Update(float dt)
+{
+    auto const& parents = gMediator.GetChangeTracker<Parent>();
+    auto const& transforms = gMediator.GetChangeTracker<Transform>();
+    auto const& worldMatrices = gMediator.GetChangeTracker<WorldMatrix>();
+
+    // With the same count and every member in its own slot, the member set is unchanged
+    bool rebuild = mEntities.Size() != mMemberCount;
+
+    for (auto it = mEntities.begin(); !rebuild && it != mEntities.end(); ++it)
+    {
+        Entity entity = *it;
+        std::uint32_t slot = mMemberSlots[GetEntityIndex(entity)];
+
+        rebuild = slot == NO_SLOT || mSlotEntities[slot] != entity || parents.ChangedSince(entity, mSeenVersion);
+    }
+
+    if (rebuild)
+    {
+        Rebuild();
+    }
+    else
+    {
+        for (std::uint32_t slot = 0; slot < mHierarchy.Size(); ++slot)
+        {
+            Entity entity = mSlotEntities[slot];
+            bool outsideParent = mHierarchy.Parent(slot) == TransformHierarchy::NO_PARENT;
+
+            if (outsideParent ? worldMatrices.ChangedSince(entity, mSeenVersion) : transforms.ChangedSince(entity, mSeenVersion))
+            {
+                LoadLocal(slot);
+                mHierarchy.MarkDirty(slot);
+            }
+        }
+    }
+
+    mHierarchy.Propagate(&gMediator.GetJobSystem());
+
+    for (std::uint32_t slot = 0; slot < mHierarchy.Size(); ++slot)
+    {
+        if (mHierarchy.IsDirty(slot) && mHierarchy.Parent(slot) != TransformHierarchy::NO_PARENT)
+        {
+            std::memcpy(&gMediator.GetComponent<WorldMatrix>(mSlotEntities[slot]).matrix[0][0], mHierarchy.World(slot), 16 * sizeof(float));
+        }
+    }
+
+    mHierarchy.ClearDirty();
+
+    // After the writes above, so they are not seen as changes next time
+    mSeenVersion = gMediator.AdvanceChangeVersion();
+}
+
+void HierarchySystem::Rebuild()
+{
+    for (std::uint32_t slot = 0; slot < mSlotEntities.size(); ++slot)
+    {
+        if (mHierarchy.Parent(slot) != TransformHierarchy::NO_PARENT)
+        {
+            mMemberSlots[GetEntityIndex(mSlotEntities[slot])] = NO_SLOT;
+        }
+    }
+
+    // Members are nodes [0, mMemberCount); parents outside the system are appended as roots
+    mNodeEntities.assign(mEntities.begin(), mEntities.end());
+    mMemberCount = mNodeEntities.size();
+
+    for (std::uint32_t node = 0; node < mMemberCount; ++node)
+    {
+        mNodeOf[GetEntityIndex(mNodeEntities[node])] = node;
+    }
+
+    mNodeParents.resize(mMemberCount);
+
+    for (std::uint32_t node = 0; node < mMemberCount; ++node)
+    {
+        Entity parent = gMediator.GetComponent<Parent const>(mNodeEntities[node]).entity;
+
+        assert(gMediator.IsAlive(parent) && "Parent destroyed before its children.");
+
+        std::uint32_t& parentNode = mNodeOf[GetEntityIndex(parent)];
+
+        if (parentNode == NO_SLOT)
+        {
+            assert(gMediator.HasComponent<WorldMatrix>(parent) && "Parent has no WorldMatrix.");
+
+            parentNode = static_cast<std::uint32_t>(mNodeEntities.size());
+            mNodeEntities.push_back(parent);
+            mNodeParents.push_back(TransformHierarchy::NO_PARENT);
+        }
+
+        mNodeParents[node] = parentNode;
+    }
+
+    mHierarchy.Build(mNodeParents);
+
+    mSlotEntities.resize(mNodeEntities.size());
+
+    for (std::uint32_t slot = 0; slot < mHierarchy.Size(); ++slot)
+    {
+        std::uint32_t node = mHierarchy.Node(slot);
+        Entity entity = mNodeEntities[node];
+
+        mSlotEntities[slot] = entity;
+        mNodeOf[GetEntityIndex(entity)] = NO_SLOT;
+
+        if (node < mMemberCount)
+        {
+            mMemberSlots[GetEntityIndex(entity)] = slot;
+        }
+
+        LoadLocal(slot);
+    }
+}
+
+void HierarchySystem::LoadLocal(std::uint32_t slot)
+{
+    Entity entity = mSlotEntities[slot];
+
+    if (mHierarchy.Parent(slot) == TransformHierarchy::NO_PARENT)
+    {
+        assert(gMediator.IsAlive(entity) && "Parent destroyed before its children; reparent or destroy the children first.");
+
+        std::memcpy(mHierarchy.Local(slot), &gMediator.GetComponent<WorldMatrix const>(entity).matrix[0][0], 16 * sizeof(float));
+        return;
+    }
+
+    auto const& transform = gMediator.GetComponent<Transform const>(entity);
+
+    TransformMath::WorldMatrix(
+        transform.position.x, transform.position.y, transform.position.z, transform.rotation.y,
+        transform.scale.x, transform.scale.y, transform.scale.z, mHierarchy.Local(slot));
+}
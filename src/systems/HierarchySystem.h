@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/ChangeTracker.h"
+#include "core/System.h"
+#include "graphics/TransformHierarchy.h"
+#include <cstdint>
+#include <vector>
+
+
+// World matrices of entities with a Parent: parent world * local Transform, down any depth. The
+// members and the parents above them are kept in a TransformHierarchy, rebuilt only when a Parent is
+// added, changed or removed; each update marks the members whose Transform changed and the outside
+// parents whose WorldMatrix changed, propagates, and writes back only the recomputed matrices.
+//
+// Runs after TransformSystem, which leaves parented entities alone. A parent must not be destroyed
+// while children still point at it: reparent or destroy the children first.
+class HierarchySystem : public System
+{
+public:
+    void Init();
+
+    void Update(float dt);
+
+private:
+    static constexpr std::uint32_t NO_SLOT = ~std::uint32_t{0};
+
+    void Rebuild();
+
+    // Loads the slot's local matrix from its Transform, or from its WorldMatrix for an outside parent
+    void LoadLocal(std::uint32_t slot);
+
+    TransformHierarchy mHierarchy;
+
+    // Entity at each hierarchy slot: members, plus the outside parents at the roots
+    std::vector<Entity> mSlotEntities;
+
+    // Entity index -> slot, for members only
+    std::vector<std::uint32_t> mMemberSlots;
+    std::size_t mMemberCount{};
+
+    // Rebuild scratch
+    std::vector<Entity> mNodeEntities;
+    std::vector<std::uint32_t> mNodeParents;
+    std::vector<std::uint32_t> mNodeOf;
+
+    ChangeVersion mSeenVersion{};
+};
@@ -3,9 +3,11 @@
 #include "components/Camera.h"
 #include "components/Renderable.h"
 #include "components/Transform.h"
+#include "components/WorldMatrix.h"
 #include "core/Mediator.h"
 #include "graphics/Shader.h"
-#include <cmath>
+#include "graphics/SpatialIndex.h"
+#include <algorithm>
 
 
 extern Mediator gMediator;
@@ -13,10 +15,16 @@ extern Mediator gMediator;
 
 void RenderSystem::Init()
 {
-	gMediator.AddEventListener(METHOD_LISTENER(Events::Window::RESIZED, RenderSystem::WindowSizeListener));
+	gMediator.AddEventListener<Events::Window::Resized, &RenderSystem::WindowSizeListener>(this);
 
 	mShader = std::make_unique<Shader>("resources/shaders/simple.vert", "resources/shaders/simple.frag");
 
+	mFrameUniforms = std::make_unique<UniformBuffer<FrameUniforms>>(FRAME_UNIFORM_BINDING);
+	mShader->bindUniformBlock("FrameData", FRAME_UNIFORM_BINDING);
+
+	glGenBuffers(1, &mInstanceVBO);
+	mInstanceSlots.assign(gMediator.GetMaxEntities(), NO_SLOT);
+
 	mCamera = gMediator.CreateEntity();
 
 
@@ -38,89 +46,310 @@ void RenderSystem::Init()
 
 void RenderSystem::Update(float dt)
 {
-	mShader->use();
-	glBindVertexArray(mVAO);
+	UpdateInstances();
+	Cull();
+	Submit();
 
-	auto& cameraTransform = gMediator.GetComponent<Transform>(mCamera);
-	auto& camera = gMediator.GetComponent<Camera>(mCamera);
+	// After this frame's reads, so the next frame sees only later writes
+	mSeenVersion = gMediator.AdvanceChangeVersion();
+}
+
+void RenderSystem::UpdateInstances()
+{
+	auto const& renderables = gMediator.GetChangeTracker<Renderable>();
+	auto const& worldMatrices = gMediator.GetChangeTracker<WorldMatrix>();
+
+	mDirtyBegin = mInstances.size();
+	mDirtyEnd = 0;
+	mRebuilt = false;
 
-	for (auto const& entity : mEntities)
+	// With the same count and every member in its own slot, the member set is unchanged
+	bool rebuild = mEntities.Size() != mInstanceEntities.size();
+
+	for (auto it = mEntities.begin(); !rebuild && it != mEntities.end(); ++it)
 	{
-		auto const& transform = gMediator.GetComponent<Transform>(entity);
-		auto const& renderable = gMediator.GetComponent<Renderable>(entity);
+		Entity entity = *it;
+		std::uint32_t slot = mInstanceSlots[GetEntityIndex(entity)];
+
+		if (slot == NO_SLOT || mInstanceEntities[slot] != entity || renderables.ChangedSince(entity, mSeenVersion))
+		{
+			rebuild = true;
+		}
+		else if (worldMatrices.ChangedSince(entity, mSeenVersion))
+		{
+			mInstances[slot].Model = gMediator.GetComponent<WorldMatrix const>(entity).matrix;
+			UpdateSphere(slot, gMediator.GetComponent<Renderable const>(entity).model->getBounds());
+			mDirtyBegin = std::min<std::size_t>(mDirtyBegin, slot);
+			mDirtyEnd = std::max<std::size_t>(mDirtyEnd, slot + 1);
+		}
+	}
 
-		glm::mat4 view = glm::mat4(1.0f);
-		view[0][3] = -cameraTransform.position.x;
-		view[1][3] = -cameraTransform.position.y;
-		view[2][3] = -cameraTransform.position.z;
+	if (rebuild)
+	{
+		BuildInstances();
+	}
+}
 
-		glm::mat4 rotY = glm::mat4(1.0f);
+void RenderSystem::BuildInstances()
+{
+	mBatchIndex.clear();
+	mBatches.clear();
+	mGatheredEntities.clear();
+	mGatheredInstances.clear();
+	mGatheredBatch.clear();
+	mGatheredBounds.clear();
+
+	for (Entity entity : mInstanceEntities)
+	{
+		mInstanceSlots[GetEntityIndex(entity)] = NO_SLOT;
+	}
 
-		float cos_theta_y = cosf(transform.rotation.y);
-		float sin_theta_y = sinf(transform.rotation.y);
+	Model* lastModel = nullptr;
+	std::uint32_t lastBatch = 0;
 
-		rotY[0][0] = cos_theta_y;
-		rotY[2][0] = -sin_theta_y;
-		rotY[0][2] = sin_theta_y;
-		rotY[2][2] = cos_theta_y;
+	// Gather each entity's instance and batch
+	gMediator.Each<Transform const, Renderable const, WorldMatrix const>(
+		[&](Entity entity, Transform const&, Renderable const& renderable, WorldMatrix const& world)
+	{
+		mGatheredEntities.push_back(entity);
+		mGatheredInstances.push_back(InstanceData{.Model = world.matrix, .Color = glm::vec4(renderable.color, 1.0f)});
+		mGatheredBounds.push_back(&renderable.model->getBounds());
+
+		// Neighbours usually share a model, so most lookups never reach the map
+		Model* model = renderable.model.get();
+
+		if (model != lastModel)
+		{
+			auto [it, inserted] = mBatchIndex.try_emplace(model, static_cast<std::uint32_t>(mBatches.size()));
+
+			if (inserted)
+			{
+				mBatches.push_back(Batch{.model = model});
+			}
 
+			lastModel = model;
+			lastBatch = it->second;
+		}
 
-		glm::mat4 rotX = glm::mat4(1.0f);
+		++mBatches[lastBatch].count;
+		mGatheredBatch.push_back(lastBatch);
+	});
 
-		float cosThetaX = cosf(transform.rotation.x);
-		float sinThetaX = sinf(transform.rotation.x);
+	// Counting sort by batch so each model's instances are contiguous
+	std::uint32_t first = 0;
 
-		rotX[1][1] = cosThetaX;
-		rotX[2][1] = sinThetaX;
-		rotX[1][2] = -sinThetaX;
-		rotX[2][2] = cosThetaX;
+	for (auto& batch : mBatches)
+	{
+		batch.first = first;
+		first += batch.count;
+		batch.count = 0;
+	}
 
+	mInstances.resize(mGatheredInstances.size());
+	mInstanceEntities.resize(mGatheredEntities.size());
+	mSpheres.Resize(mGatheredInstances.size());
 
-		glm::mat4 rotZ = glm::mat4(1.0f);
+	for (std::size_t i = 0; i < mGatheredInstances.size(); ++i)
+	{
+		Batch& batch = mBatches[mGatheredBatch[i]];
+		std::uint32_t slot = batch.first + batch.count++;
 
-		float cosThetaZ = cosf(transform.rotation.z);
-		float sinThetaZ = sinf(transform.rotation.z);
+		mInstances[slot] = mGatheredInstances[i];
+		mInstanceEntities[slot] = mGatheredEntities[i];
+		mInstanceSlots[GetEntityIndex(mGatheredEntities[i])] = slot;
+		UpdateSphere(slot, *mGatheredBounds[i]);
+	}
 
-		rotZ[0][0] = cosThetaZ;
-		rotZ[1][0] = sinThetaZ;
-		rotZ[0][1] = -sinThetaZ;
-		rotZ[1][1] = cosThetaZ;
+	mDirtyBegin = 0;
+	mDirtyEnd = mInstances.size();
+	mRebuilt = true;
+}
 
+void RenderSystem::UpdateSphere(std::uint32_t slot, Bounds const& bounds)
+{
+	float x, y, z, r;
+	Culling::WorldSphere(&mInstances[slot].Model[0][0], bounds.Center.x, bounds.Center.y, bounds.Center.z, bounds.Radius, x, y, z, r);
 
-		glm::mat4 translate = glm::translate(glm::mat4(1.0f), transform.position);
+	mSpheres.Set(slot, x, y, z, r);
+}
 
-		glm::mat4 scaleMat = glm::scale(glm::mat4(1.0f), transform.scale);
+void RenderSystem::Cull()
+{
+	auto const& cameraTransform = gMediator.GetComponent<Transform const>(mCamera);
+	auto const& camera = gMediator.GetComponent<Camera const>(mCamera);
 
-		glm::mat4 model = translate * scaleMat * rotY;
+	mView = glm::lookAt(cameraTransform.position, cameraTransform.position + cameraTransform.forward, cameraTransform.up);
+	mProjection = camera.projectionMatrix;
+	mViewPosition = glm::vec4(cameraTransform.position, 1.0f);
 
-		glm::mat4 projection = camera.projectionMatrix;
+	glm::mat4 viewProjection = mProjection * mView;
+	CullContext context{.system = this, .frustum = Culling::ExtractFrustum(&viewProjection[0][0])};
 
-		view = glm::lookAt(cameraTransform.position, cameraTransform.position + cameraTransform.forward, cameraTransform.up);
+	std::swap(mVisible, mPreviousVisible);
+	mVisible.clear();
 
-		mShader->setUniform<glm::mat4>("uModel", model);
-		mShader->setUniform<glm::mat4>("uView", view);
-		mShader->setUniform<glm::mat4>("uProj", projection);
-		mShader->setUniform<glm::vec3>("uColor", renderable.color);
+	std::size_t const chunkCount = (mSpheres.Size() + CULL_GRAIN - 1) / CULL_GRAIN;
 
-		// Lightning uniform
-		mShader->setUniform("uViewPos", cameraTransform.position);
-		mShader->setUniform("uLightPos", glm::vec3(3.5f, 9.0f, 0.0f));
-		mShader->setUniform("uLightColor", glm::vec3(1.0f, 0.95f, 0.9f));
-		mShader->setUniform("uAmbientColor", glm::vec3(0.5, 0.5, 0.3f));
-		mShader->setUniform("uSpecularStrength", 10.0f);
-		mShader->setUniform("uSpecularPower", 512.0f);
-		mShader->setUniform("uLightAttenuation", glm::vec3(0.2f, 0.07f, 0.03f));
+	if (gMediator.HasResource<SpatialIndex>())
+	{
+		// Only the parts of the tree inside the frustum are visited; the boxes it reports are a little
+		// more generous than the spheres
+		gMediator.GetResource<SpatialIndex>().QueryFrustum(context.frustum, [&](Entity entity)
+		{
+			std::uint32_t slot = mInstanceSlots[GetEntityIndex(entity)];
+
+			if (slot != NO_SLOT && mInstanceEntities[slot] == entity)
+			{
+				mVisible.push_back(slot);
+			}
+		});
 
-		renderable.model->draw(*mShader);
+		std::sort(mVisible.begin(), mVisible.end());
+	}
+	else if (chunkCount <= 1)
+	{
+		Culling::CullSpheres(context.frustum, mSpheres, 0, mSpheres.Size(), mVisible);
+	}
+	else
+	{
+		mChunkVisible.resize(chunkCount);
+
+		JobSystem& jobSystem = gMediator.GetJobSystem();
+		JobCounter counter;
+
+		for (std::size_t i = 0; i < chunkCount; ++i)
+		{
+			jobSystem.Submit(Job{
+				.function = &RunCullChunk,
+				.context = &context,
+				.index = i,
+				.counter = &counter
+			});
+		}
+
+		jobSystem.Wait(counter);
+
+		// Chunks cover ascending slot ranges, so concatenating keeps the list sorted
+		for (std::size_t i = 0; i < chunkCount; ++i)
+		{
+			mVisible.insert(mVisible.end(), mChunkVisible[i].begin(), mChunkVisible[i].end());
+		}
+	}
+
+	// Slots are grouped by batch, so each batch's visible slots are a run of the list
+	mVisibleBatches.clear();
+	std::uint32_t visible = 0;
+
+	for (auto const& batch : mBatches)
+	{
+		std::uint32_t first = visible;
+
+		while (visible < mVisible.size() && mVisible[visible] < batch.first + batch.count)
+		{
+			++visible;
+		}
+
+		if (visible > first)
+		{
+			mVisibleBatches.push_back(Batch{.model = batch.model, .first = first, .count = visible - first});
+		}
+	}
+}
+
+void RenderSystem::RunCullChunk(void* context, std::size_t index)
+{
+	auto const& cull = *static_cast<CullContext*>(context);
+	RenderSystem& system = *cull.system;
+
+	std::size_t begin = index * CULL_GRAIN;
+	std::size_t end = std::min(system.mSpheres.Size(), begin + CULL_GRAIN);
+
+	system.mChunkVisible[index].clear();
+	Culling::CullSpheres(cull.frustum, system.mSpheres, begin, end, system.mChunkVisible[index]);
+}
+
+void RenderSystem::Submit()
+{
+	mStats = RenderStats{
+		.batches = static_cast<std::uint32_t>(mBatches.size()),
+		.instances = static_cast<std::uint32_t>(mInstances.size()),
+		.visibleInstances = static_cast<std::uint32_t>(mVisible.size())
+	};
+
+	if (mVisible.empty())
+	{
+		return;
+	}
+
+	mShader->use();
+	glBindVertexArray(mVAO);
+
+	mFrameUniforms->upload(FrameUniforms{
+		.view = mView,
+		.proj = mProjection,
+		.viewPos = mViewPosition,
+
+		// Lightning
+		.lightPos = glm::vec4(3.5f, 9.0f, 0.0f, 1.0f),
+		.lightColor = glm::vec4(1.0f, 0.95f, 0.9f, 0.0f),
+		.ambientColor = glm::vec4(0.5, 0.5, 0.3f, 0.0f),
+		.lightAttenuation = glm::vec4(0.2f, 0.07f, 0.03f, 0.0f),
+		.specularStrength = 10.0f,
+		.specularPower = 512.0f
+	});
+
+	glBindBuffer(GL_ARRAY_BUFFER, mInstanceVBO);
+
+	// A new visible set respecifies the whole store, letting the driver orphan the old copy. Otherwise
+	// only the visible instances among this frame's changes are uploaded; they are a contiguous run of
+	// the sorted list. A static view uploads nothing.
+	if (mRebuilt || mVisible != mPreviousVisible)
+	{
+		mVisibleInstances.resize(mVisible.size());
+
+		for (std::size_t i = 0; i < mVisible.size(); ++i)
+		{
+			mVisibleInstances[i] = mInstances[mVisible[i]];
+		}
+
+		glBufferData(GL_ARRAY_BUFFER, mVisibleInstances.size() * sizeof(InstanceData), mVisibleInstances.data(), GL_DYNAMIC_DRAW);
+		mStats.uploadedInstances = mStats.visibleInstances;
+	}
+	else if (mDirtyEnd > mDirtyBegin)
+	{
+		std::size_t first = std::lower_bound(mVisible.begin(), mVisible.end(), mDirtyBegin) - mVisible.begin();
+		std::size_t last = std::lower_bound(mVisible.begin() + first, mVisible.end(), mDirtyEnd) - mVisible.begin();
+
+		for (std::size_t i = first; i < last; ++i)
+		{
+			mVisibleInstances[i] = mInstances[mVisible[i]];
+		}
+
+		if (last > first)
+		{
+			glBufferSubData(
+				GL_ARRAY_BUFFER,
+				static_cast<GLintptr>(first * sizeof(InstanceData)),
+				static_cast<GLsizeiptr>((last - first) * sizeof(InstanceData)),
+				&mVisibleInstances[first]);
+			mStats.uploadedInstances = static_cast<std::uint32_t>(last - first);
+		}
+	}
+
+	for (auto const& batch : mVisibleBatches)
+	{
+		mStats.drawCalls += static_cast<std::uint32_t>(
+			batch.model->drawInstanced(*mShader, mInstanceVBO, batch.first, static_cast<GLsizei>(batch.count)));
 	}
 
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 }
 
-void RenderSystem::WindowSizeListener(Event& event)
+void RenderSystem::WindowSizeListener(Events::Window::Resized const& event)
 {
-	auto windowWidth = event.GetParam<unsigned int>(Events::Window::Resized::WIDTH);
-	auto windowHeight = event.GetParam<unsigned int>(Events::Window::Resized::HEIGHT);
+	auto windowWidth = event.width;
+	auto windowHeight = event.height;
 
 	auto& camera = gMediator.GetComponent<Camera>(mCamera);
 	camera.projectionMatrix = Camera::BuildProjectionMatrix(45.0f, 0.1f, 1000.0f, windowWidth, windowHeight);
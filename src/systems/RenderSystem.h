@@ -1,13 +1,59 @@
 #pragma once
 
+#include "core/ChangeTracker.h"
+#include "core/Event.h"
 #include "core/System.h"
+#include "graphics/Culling.h"
+#include "graphics/Mesh.h"
 #include "graphics/Shader.h"
+#include "graphics/UniformBuffer.h"
+#include <cstdint>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 
-class Event;
+class Model;
 
 
+// Mirrors the std140 FrameData block in simple.vert and simple.frag
+struct alignas(16) FrameUniforms
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::vec4 viewPos;
+    glm::vec4 lightPos;
+    glm::vec4 lightColor;
+    glm::vec4 ambientColor;
+    glm::vec4 lightAttenuation;
+    float specularStrength;
+    float specularPower;
+};
+
+
+// Counters for the most recent RenderSystem::Update
+struct RenderStats
+{
+    std::uint32_t drawCalls{};
+    std::uint32_t batches{};
+    std::uint32_t instances{};
+    std::uint32_t visibleInstances{};
+    std::uint32_t uploadedInstances{};
+};
+
+
+// Entities sharing a Model are drawn together: their model matrices and colors are packed into one
+// instance buffer and each model is drawn once per mesh with glDrawElementsInstanced, so draw calls
+// follow the number of distinct models rather than the number of entities.
+//
+// The instance layout persists between frames. World matrices come from WorldMatrix (kept by
+// TransformSystem); only the instances whose WorldMatrix changed are patched, and the layout is
+// rebuilt only when members join or leave or a Renderable changes.
+//
+// Each instance also has a world-space bounding sphere from its Model's bounds. A SIMD pass, split
+// across the job system for large scenes, tests them against the camera frustum; only the compacted
+// visible list reaches the GPU, so off-screen instances cost no vertex work and no bandwidth. When a
+// SpatialIndex resource exists, its tree is queried instead, so culling skips whole regions.
 class RenderSystem : public System
 {
 public:
@@ -17,13 +63,92 @@ public:
 
     Entity GetCameraEntity() const { return mCamera; }
 
+    RenderStats const& GetStats() const { return mStats; }
+
 private:
-    void WindowSizeListener(Event& event);
+    // One model's instances, a contiguous range of mInstances or of the visible list
+    struct Batch
+    {
+        Model* model{};
+        std::uint32_t first{};
+        std::uint32_t count{};
+    };
+
+    void WindowSizeListener(Events::Window::Resized const& event);
+
+    // CPU stage: patches the instances of entities whose WorldMatrix changed, or rebuilds the
+    // layout if the set of members or a Renderable changed
+    void UpdateInstances();
+
+    // Regroups every member's instance by model and records each entity's slot
+    void BuildInstances();
+
+    // The instance's world sphere, from its world matrix and its model's local bounds
+    void UpdateSphere(std::uint32_t slot, Bounds const& bounds);
+
+    // Reads the camera and collects the instances whose sphere touches its frustum, by batch
+    void Cull();
+
+    struct CullContext
+    {
+        RenderSystem* system{};
+        Frustum frustum{};
+    };
+
+    // Culls CULL_GRAIN slots into mChunkVisible[index]
+    static void RunCullChunk(void* context, std::size_t index);
+
+    // GPU stage: uploads the frame's uniforms and whatever part of the visible instances changed, then
+    // only binds and draws
+    void Submit();
+
+    static constexpr GLuint FRAME_UNIFORM_BINDING = 0;
+    static constexpr std::uint32_t NO_SLOT = ~std::uint32_t{0};
+    static constexpr std::size_t CULL_GRAIN = 8192;
 
     std::unique_ptr<Shader> mShader;
+    std::unique_ptr<UniformBuffer<FrameUniforms>> mFrameUniforms;
 
     Entity mCamera;
 
     GLuint mVAO{};
     GLuint mVBO{};
+    GLuint mInstanceVBO{};
+
+    // Instance layout, kept until members or Renderables change
+    std::unordered_map<Model*, std::uint32_t> mBatchIndex;
+    std::vector<Batch> mBatches;
+    std::vector<InstanceData> mInstances;
+    std::vector<Entity> mInstanceEntities;
+    std::vector<std::uint32_t> mInstanceSlots;
+
+    // Gather scratch for rebuilds
+    std::vector<Entity> mGatheredEntities;
+    std::vector<InstanceData> mGatheredInstances;
+    std::vector<std::uint32_t> mGatheredBatch;
+    std::vector<Bounds const*> mGatheredBounds;
+
+    // Instances [mDirtyBegin, mDirtyEnd) changed this frame; a rebuild changes them all
+    std::size_t mDirtyBegin{};
+    std::size_t mDirtyEnd{};
+    bool mRebuilt{};
+
+    // World bounding sphere of each instance slot
+    SphereSoA mSpheres;
+
+    glm::mat4 mView{1.0f};
+    glm::mat4 mProjection{1.0f};
+    glm::vec4 mViewPosition{0.0f};
+
+    // Slots that passed culling, ascending and so grouped by batch, and the same list last frame. The
+    // instance buffer holds mVisibleInstances, their instances in that order.
+    std::vector<std::uint32_t> mVisible;
+    std::vector<std::uint32_t> mPreviousVisible;
+    std::vector<std::vector<std::uint32_t>> mChunkVisible;
+    std::vector<Batch> mVisibleBatches;
+    std::vector<InstanceData> mVisibleInstances;
+
+    ChangeVersion mSeenVersion{};
+
+    RenderStats mStats{};
 };
@@ -34,8 +34,8 @@ void SkyboxRenderSystem::Init()
 void SkyboxRenderSystem::Update(float dt)
 {
     Entity camera = gMediator.GetMainCamera();
-    auto& camTransform = gMediator.GetComponent<Transform>(camera);
-    auto& cam = gMediator.GetComponent<Camera>(camera);
+    auto& camTransform = gMediator.GetComponent<Transform const>(camera);
+    auto& cam = gMediator.GetComponent<Camera const>(camera);
 
 
     glm::mat4 viewMatrix = glm::lookAt(camTransform.position,
@@ -46,11 +46,5 @@ void SkyboxRenderSystem::Update(float dt)
     glm::mat4 projection = cam.projectionMatrix;
 
 
-    mSkyboxShader->use();
-
-    mSkyboxShader->setUniform("uView", viewNoTranslation);
-    mSkyboxShader->setUniform("uProj", projection);
-    mSkyboxShader->setUniform("skybox", 0);
-
     mSkybox->draw(*mSkyboxShader, viewNoTranslation, projection);
 }
@@ -0,0 +1,79 @@
+#include "SpatialIndexSystem.h"
+
+#include "components/Renderable.h"
+#include "components/WorldMatrix.h"
+#include "core/Mediator.h"
+#include "graphics/SpatialIndex.h"
+
+
+extern Mediator gMediator;
+
+
+namespace {
+
+Aabb WorldBounds(Entity entity)
+{
+    Bounds const& local = gMediator.GetComponent<Renderable const>(entity).model->getBounds();
+    auto const& world = gMediator.GetComponent<WorldMatrix const>(entity).matrix;
+
+    Aabb box{{local.Min.x, local.Min.y, local.Min.z}, {local.Max.x, local.Max.y, local.Max.z}};
+    return Aabb::Transformed(&world[0][0], box);
+}
+
+}
+
+
+void SpatialIndexSystem::Init()
+{
+    gMediator.AddResource<SpatialIndex>(gMediator.GetMaxEntities());
+}
+
+void SpatialIndexSystem::Update(float dt)
+{
+    auto& index = gMediator.GetResource<SpatialIndex>();
+    auto const& renderables = gMediator.GetChangeTracker<Renderable>();
+    auto const& worldMatrices = gMediator.GetChangeTracker<WorldMatrix>();
+
+    for (Entity entity : mEntities)
+    {
+        if (!index.Contains(entity))
+        {
+            // A destroyed member's index can be reused before the sweep below sees it leave
+            Entity stale = index.GetEntity(GetEntityIndex(entity));
+
+            if (stale != NULL_ENTITY)
+            {
+                index.Remove(stale);
+                mIndexed.Remove(stale);
+            }
+
+            index.Insert(entity, WorldBounds(entity));
+            mIndexed.Insert(entity);
+        }
+        else if (worldMatrices.ChangedSince(entity, mSeenVersion) || renderables.ChangedSince(entity, mSeenVersion))
+        {
+            index.Update(entity, WorldBounds(entity));
+        }
+    }
+
+    // Every member is indexed now, so any surplus left the system
+    if (mIndexed.Size() != mEntities.Size())
+    {
+        mRemoved.clear();
+        for (Entity entity : mIndexed)
+        {
+            if (!mEntities.Contains(entity))
+            {
+                mRemoved.push_back(entity);
+            }
+        }
+
+        for (Entity entity : mRemoved)
+        {
+            index.Remove(entity);
+            mIndexed.Remove(entity);
+        }
+    }
+
+    mSeenVersion = gMediator.AdvanceChangeVersion();
+}
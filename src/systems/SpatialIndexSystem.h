@@ -0,0 +1,24 @@
+#pragma once
+
+#include "core/ChangeTracker.h"
+#include "core/System.h"
+#include <vector>
+
+
+// Owns the SpatialIndex resource and keeps it current: members are inserted with the world box of
+// their Model's bounds, re-boxed when their WorldMatrix or Renderable changes, and removed when they
+// leave. A static scene costs one version compare per entity and never touches the tree.
+class SpatialIndexSystem : public System
+{
+public:
+    void Init();
+
+    void Update(float dt);
+
+private:
+    ChangeVersion mSeenVersion{};
+
+    // Entities in the index, to find the ones that left
+    SparseSet mIndexed;
+    std::vector<Entity> mRemoved;
+};
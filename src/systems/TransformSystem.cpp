@@ -0,0 +1,58 @@
+#include "TransformSystem.h"
+
+#include "components/Parent.h"
+#include "components/Transform.h"
+#include "components/WorldMatrix.h"
+#include "core/Mediator.h"
+#include <cstring>
+
+
+extern Mediator gMediator;
+
+
+void TransformSystem::Init()
+{
+}
+
+void TransformSystem::Update(float dt)
+{
+    auto const& parents = gMediator.GetChangeTracker<Parent>();
+    auto const& transforms = gMediator.GetChangeTracker<Transform>();
+    auto const& worldMatrices = gMediator.GetChangeTracker<WorldMatrix>();
+
+    mDirty.clear();
+    mTransforms.Clear();
+
+    for (Entity entity : mEntities)
+    {
+        // A new member's Transform can be older than the last update, but its WorldMatrix is not; an
+        // entity that just lost its Parent needs its matrix without the parent's again
+        bool changed = transforms.ChangedSince(entity, mSeenVersion) || worldMatrices.ChangedSince(entity, mSeenVersion) ||
+            parents.ChangedSince(entity, mSeenVersion);
+
+        // Parented entities belong to HierarchySystem
+        if (changed && !gMediator.HasComponent<Parent>(entity))
+        {
+            auto const& transform = gMediator.GetComponent<Transform const>(entity);
+
+            mTransforms.Push(
+                transform.position.x, transform.position.y, transform.position.z, transform.rotation.y,
+                transform.scale.x, transform.scale.y, transform.scale.z);
+            mDirty.push_back(entity);
+        }
+    }
+
+    if (!mDirty.empty())
+    {
+        mMatrices.resize(16 * mDirty.size());
+        TransformMath::WorldMatrices(mTransforms, mMatrices.data());
+
+        for (std::size_t i = 0; i < mDirty.size(); ++i)
+        {
+            std::memcpy(&gMediator.GetComponent<WorldMatrix>(mDirty[i]).matrix[0][0], &mMatrices[16 * i], 16 * sizeof(float));
+        }
+    }
+
+    // After the writes above, so they are not seen as changes next time
+    mSeenVersion = gMediator.AdvanceChangeVersion();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core/ChangeTracker.h"
+#include "core/System.h"
+#include "graphics/TransformMath.h"
+#include <vector>
+
+
+// Keeps WorldMatrix in sync with Transform. Only entities whose Transform was written, or that just
+// gained a WorldMatrix, since the previous update are recomputed, together in one SIMD pass; a
+// static scene costs one version compare per entity. Entities with a Parent are left to
+// HierarchySystem.
+class TransformSystem : public System
+{
+public:
+    void Init();
+
+    void Update(float dt);
+
+private:
+    ChangeVersion mSeenVersion{};
+
+    // Scratch for the entities recomputed this update
+    std::vector<Entity> mDirty;
+    TransformSoA mTransforms;
+    std::vector<float> mMatrices;
+};
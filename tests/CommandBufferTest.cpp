@@ -0,0 +1,150 @@
+// Command buffer playback against system membership, under both storage backends. Exits non-zero
+// on the first failed check.
+
+#include "core/Mediator.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1); \
+        } \
+    } while (false)
+
+
+namespace {
+
+struct Position
+{
+    float x{};
+};
+
+struct Velocity
+{
+    float x{};
+};
+
+class MovementSystem : public System
+{
+public:
+    void Init() override {}
+    void Update(float) override {}
+};
+
+// Empty signature: matches every entity, whatever it holds
+class WildcardSystem : public System
+{
+public:
+    void Init() override {}
+    void Update(float) override {}
+};
+
+
+std::shared_ptr<MovementSystem> SetUp(Mediator& mediator, ComponentStorage storage)
+{
+    mediator.Init(16, storage);
+    mediator.RegisterComponent<Position>();
+    mediator.RegisterComponent<Velocity>();
+
+    auto system = mediator.RegisterSystem<MovementSystem>();
+
+    Signature signature;
+    signature.set(mediator.GetComponentType<Position>());
+    mediator.SetSystemSignature<MovementSystem>(signature);
+
+    return system;
+}
+
+// The removal drops the only component the system matches on, so the destroyed entity's final
+// signature no longer points at the system holding it
+void RemoveThenDestroy(ComponentStorage storage)
+{
+    Mediator mediator;
+    auto system = SetUp(mediator, storage);
+
+    Entity entity = mediator.CreateEntity();
+    mediator.AddComponent(entity, Position{});
+    mediator.AddComponent(entity, Velocity{});
+    CHECK(system->mEntities.Contains(entity));
+
+    auto& buffer = mediator.GetCommandBuffer();
+    buffer.RemoveComponent<Position>(entity);
+    buffer.DestroyEntity(entity);
+    mediator.FlushCommandBuffers();
+
+    CHECK(!mediator.IsAlive(entity));
+    CHECK(!system->mEntities.Contains(entity));
+    CHECK(system->mEntities.Size() == 0);
+}
+
+// With its last component gone the entity's signature is empty, which must still reach the systems
+// with an empty signature that hold it
+void RemoveLastThenDestroy(ComponentStorage storage, bool deferred)
+{
+    Mediator mediator;
+    SetUp(mediator, storage);
+
+    auto system = mediator.RegisterSystem<WildcardSystem>();
+    mediator.SetSystemSignature<WildcardSystem>(Signature{});
+
+    Entity entity = mediator.CreateEntity();
+    mediator.AddComponent(entity, Position{});
+    CHECK(system->mEntities.Contains(entity));
+
+    mediator.RemoveComponent<Position>(entity);
+
+    if (deferred)
+    {
+        mediator.GetCommandBuffer().DestroyEntity(entity);
+        mediator.FlushCommandBuffers();
+    }
+    else
+    {
+        mediator.DestroyEntity(entity);
+    }
+
+    CHECK(!mediator.IsAlive(entity));
+    CHECK(!system->mEntities.Contains(entity));
+    CHECK(system->mEntities.Size() == 0);
+}
+
+void AddThenDestroy(ComponentStorage storage)
+{
+    Mediator mediator;
+    auto system = SetUp(mediator, storage);
+
+    Entity entity = mediator.CreateEntity();
+    mediator.AddComponent(entity, Velocity{});
+    CHECK(!system->mEntities.Contains(entity));
+
+    auto& buffer = mediator.GetCommandBuffer();
+    buffer.AddComponent(entity, Position{});
+    buffer.DestroyEntity(entity);
+    mediator.FlushCommandBuffers();
+
+    CHECK(!mediator.IsAlive(entity));
+    CHECK(system->mEntities.Size() == 0);
+}
+
+}
+
+
+int main()
+{
+    for (auto storage : {ComponentStorage::Sparse, ComponentStorage::Archetype})
+    {
+        RemoveThenDestroy(storage);
+        RemoveLastThenDestroy(storage, false);
+        RemoveLastThenDestroy(storage, true);
+        AddThenDestroy(storage);
+    }
+
+    std::printf("CommandBufferTest passed\n");
+    return 0;
+}